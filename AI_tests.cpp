@@ -60,7 +60,120 @@ struct test_case{
     }
 };
 
+// the square by square sum the table evaluation replaced
+int eval_by_square(const Board &brd, PawnScore pawns){
+    int midlegame = pawns.midlegame, endgame = pawns.endgame, phase = 0;
+    for(int i = 0; i < 64; ++i){
+        const pair<int, int> square_eval{brd.eval_square(i)};
+        midlegame += material_midlegame[brd[i]] + square_eval.first;
+        endgame += material_endgame[brd[i]] + square_eval.second;
+        phase += phase_table[brd[i]];
+    }
+    phase = min(phase, 24);
+    return (phase * midlegame + (24 - phase) * endgame) / 24;
+}
+
+template<Color clr>
+int64_t check_eval(Board &brd, int d, Movelist_ref list_ref){
+    assert(brd.eval_position() == eval_by_square(brd, brd.eval_pawns()));
+    if(d == 0)
+        return 1;
+    Movegen generator(brd, list_ref);
+    generator.gen_all_moves<clr>();
+    int64_t nodes = 0;
+    for(Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+        const Accumulator acc = brd.unstable_make_move<clr>(*i);
+        nodes += check_eval<change_color(clr)>(brd, d - 1, list_ref.get_ref());
+        brd.unstable_undo_move<clr>(*i, acc);
+    }
+    return nodes;
+}
+
+void check_eval_tables(const string &fen){
+    Board brd;
+    fenParser parser;
+    parser.parse_from_FEN(fen, brd);
+    Movelist_ref list_ref(list);
+    const int64_t nodes = brd.get_turn() ? check_eval<White>(brd, 3, list_ref) : check_eval<Black>(brd, 3, list_ref);
+
+    constexpr int rounds = 1'000'000;
+    int sum = 0;
+    const PawnScore pawns = brd.eval_pawns();
+    const auto start = chrono::steady_clock::now();
+    // the clobber keeps the board from being read once for all rounds
+    for(int i = 0; i < rounds; ++i){
+        asm volatile("" ::: "memory");
+        sum += brd.eval_tables().first;
+    }
+    const auto middle = chrono::steady_clock::now();
+    for(int i = 0; i < rounds; ++i){
+        asm volatile("" ::: "memory");
+        sum += eval_by_square(brd, pawns);
+    }
+    const auto end = chrono::steady_clock::now();
+    cout << "eval tables, " << nodes << " positions: " << chrono::duration<double, nano>(middle - start).count() / rounds << " ns, by square "
+         << chrono::duration<double, nano>(end - middle).count() / rounds << " ns (" << (sum & 1) << ")\n";
+}
+
+// the per iteration counts add up to the totals, and the disabled build counts nothing
+void check_stats(){
+    Board brd;
+    fenParser parser;
+    parser.parse_from_FEN("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", brd);
+    Movelist_ref list_ref(list);
+    AI bot(brd, list_ref);
+    SearchLimits limits;
+    limits.depth = 4;
+    bot.search(limits, [](const SearchInfo&){});
+    const SearchStats &stats = bot.get_stats();
+    int64_t cutoffs = 0;
+    for(const int64_t count : stats.get_cutoffs())
+        cutoffs += count;
+    if constexpr(SearchStats::enabled){
+        assert(stats.get_iteration_count() == 4);
+        int64_t nodes = 0;
+        for(int i = 0; i < stats.get_iteration_count(); ++i)
+            nodes += stats.get_iteration(i).nodes;
+        assert(nodes == stats.get_nodes() + stats.get_qnodes());
+        assert(stats.get_nodes() >= bot.all_nodes);
+        assert(cutoffs > 0 && stats.ebf() > 1.0);
+    }
+    else
+        assert(stats.get_nodes() == 0 && stats.get_iteration_count() == 0 && cutoffs == 0);
+    assert(stats.json().front() == '{' && stats.json().back() == '}');
+    cout << stats.uci_info() << "\nstats SUCCESS\n";
+}
+
+// a mate scores mate_score less its plies, with and without the table between the iterations
+void check_mate_distance(){
+    for(const bool with_table : {false, true}){
+        Board brd;
+        fenParser parser;
+        parser.parse_from_FEN("7k/8/6K1/8/8/8/8/5Q2 w - - 0 1", brd);
+        Movelist_ref list_ref(list);
+        AI bot(brd, list_ref);
+        TranspositionTable tt(1);
+        if(with_table)
+            bot.set_transposition_table(&tt);
+        SearchLimits limits;
+        limits.depth = 4;
+        assert(get<1>(bot.search(limits, [](const SearchInfo&){})) == mate_score - 1);
+        // the mated side, two plies from the root
+        parser.parse_from_FEN("7k/8/6K1/8/8/8/8/4Q3 b - - 0 1", brd);
+        assert(get<1>(bot.search(limits, [](const SearchInfo&){})) == -mate_score + 2);
+    }
+    cout << "mate distance SUCCESS\n";
+}
+
 int main(){
+    check_stats();
+    check_mate_distance();
+    for(const string fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                            "8/PPP4k/8/8/8/8/ppp4K/8 w - - 0 1"})
+        check_eval_tables(fen);
+    cout << "eval tables SUCCESS\n";
+
     test_case cases[] = {
         {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4},
         {"4k3/8/8/pppppppp/PPPPPPPP/8/8/4K3 w - - 0 1", 4},
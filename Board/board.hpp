@@ -1,7 +1,11 @@
 #pragma once
 #include "../types.hpp"
+#include "../profile.hpp"
 #include "evaltables.hpp"
+#include "pesto.hpp"
 #include "hashing.hpp"
+#include "pawnhash.hpp"
+#include <immintrin.h>
 namespace chess{
 
    
@@ -11,8 +15,13 @@ namespace chess{
 
     class Board
     {
+        friend struct CompactBoard;
     private:
         types::array<Piece, 64>  table;
+        #ifdef MAESTRO_HYBRID
+        // one bitboard per piece, bitboards[No_Piece] keeps the empty squares
+        types::array<u64, 13> bitboards;
+        #endif
         Color turn = White;
         Square white_king_position, black_king_position;
         CastlingRights castl_rights = White_OO_OOO | Black_OO_OOO;
@@ -22,26 +31,43 @@ namespace chess{
         int fifty_moves_rule = 0;
         int total_moves = 0;
 
+        // the pawn part of get_hash(), kept by set_piece
+        u64 pawn_key = 0;
+
     public:
         
         Board(){}
         
         Board(const Board &board):table(board.table), turn(board.turn), white_king_position(board.white_king_position),
         black_king_position(board.black_king_position), castl_rights(board.castl_rights), en_passant(board.en_passant),
-        fifty_moves_rule(board.fifty_moves_rule),total_moves(board.total_moves)  {}
+        fifty_moves_rule(board.fifty_moves_rule),total_moves(board.total_moves), pawn_key(board.pawn_key)  {
+            #ifdef MAESTRO_HYBRID
+            bitboards = board.bitboards;
+            #endif
+        }
+
+        Board& operator=(const Board &board) = default;
 
         friend bool operator==(const Board &left, const Board &right){
             return (left.table == right.table) && (left.turn== right.turn) && (left.white_king_position == right.white_king_position) && 
             (left.black_king_position == right.black_king_position) && (left.castl_rights == right.castl_rights) && 
             (left.en_passant == right.en_passant) &&
-            (left.fifty_moves_rule == right.fifty_moves_rule) && (left.total_moves == right.total_moves);
+            (left.fifty_moves_rule == right.fifty_moves_rule) && (left.total_moves == right.total_moves)
+            #ifdef MAESTRO_HYBRID
+            && (left.bitboards == right.bitboards)
+            #endif
+            ;
         }
 
         friend bool operator!=(const Board &left, const Board &right){
             return (left.table != right.table) || (left.turn!= right.turn) || (left.white_king_position != right.white_king_position) || 
             (left.black_king_position != right.black_king_position) || (left.castl_rights != right.castl_rights) || 
             (left.en_passant != right.en_passant) ||
-            (left.fifty_moves_rule != right.fifty_moves_rule) || (left.total_moves != right.total_moves);
+            (left.fifty_moves_rule != right.fifty_moves_rule) || (left.total_moves != right.total_moves)
+            #ifdef MAESTRO_HYBRID
+            || (left.bitboards != right.bitboards)
+            #endif
+            ;
         }
 
         template<Color color>
@@ -101,6 +127,18 @@ namespace chess{
             return table[id];
         }
         // setters
+
+        /// every write that has to stay visible to the bitboards and the pawn key goes through here,
+        /// raw writes through operator[] need init_bitboards() afterwards
+        inline void set_piece(const int id, const Piece piece){
+            pawn_key ^= pawn_zobrist_hashtable[id][table[id]] ^ pawn_zobrist_hashtable[id][piece];
+            #ifdef MAESTRO_HYBRID
+            bitboards[table[id]] ^= bit_at(id);
+            bitboards[piece] ^= bit_at(id);
+            #endif
+            table[id] = piece;
+        }
+
         void set_turn(Color color){
             turn = color;
         }
@@ -142,6 +180,18 @@ namespace chess{
         inline Square get_en_passant()const{ return en_passant;}
         inline int get_fifty_rule()const{return fifty_moves_rule;}
         inline int get_total_moves()const{return total_moves;}
+        inline u64 get_pawn_key()const{return pawn_key;}
+        template<Color color>
+        inline Square get_king_position()const{
+            if constexpr(color)
+                return white_king_position;
+            else
+                return black_king_position;
+        }
+        #ifdef MAESTRO_HYBRID
+        inline u64 get_bitboard(const Piece piece)const{return bitboards[piece];}
+        inline u64 get_occupied()const{return ~bitboards[No_Piece];}
+        #endif
 
         // methods
         void clear_board(){
@@ -149,24 +199,36 @@ namespace chess{
             {
                 piece = No_Piece;
             }
+            init_bitboards();
+        }
+
+        /// the bitboards and the pawn key from the mailbox
+        void init_bitboards(){
+            pawn_key = compute_pawn_key();
+            #ifdef MAESTRO_HYBRID
+            bitboards.fill(0);
+            for(int i = 0; i < 64; ++i){
+                bitboards[table[i]] |= bit_at(i);
+            }
+            #endif
         }
 
         template<Color color>
         inline void do_en_passant_remove(const int id){
             if constexpr(color)
-                table[id - 8] = No_Piece;
+                set_piece(id - 8, No_Piece);
             else
-                table[id + 8] = No_Piece;
+                set_piece(id + 8, No_Piece);
         }
         template<Color color>
         inline void do_rook_castling(const int id){
             if(id == short_castling_square<color>()){
-                table[short_castling_rook_from_square<color>()] = No_Piece;
-                table[short_castling_rook_to_square<color>()] = Rook_with_color<color>();
+                set_piece(short_castling_rook_from_square<color>(), No_Piece);
+                set_piece(short_castling_rook_to_square<color>(), Rook_with_color<color>());
             }   
             else{
-                table[long_castling_rook_from_square<color>()] = No_Piece;
-                table[long_castling_rook_to_square<color>()] = Rook_with_color<color>();
+                set_piece(long_castling_rook_from_square<color>(), No_Piece);
+                set_piece(long_castling_rook_to_square<color>(), Rook_with_color<color>());
             }
         }
 
@@ -182,6 +244,7 @@ namespace chess{
 
         template<Color color>
         inline Accumulator unstable_make_move(const Move_full_info move){
+            MAESTRO_PROFILE_SCOPE(Prof_make_move);
             #ifdef MAESTRO_DEBUG
             /// TODO: write checks
             #endif
@@ -218,66 +281,67 @@ namespace chess{
             switch (move.special)
             {
             case No_special:
-                table[move.to_square] = table[move.from_square];
+                set_piece(move.to_square, table[move.from_square]);
                 break;
                 
             case SP_Promotion:
-                table[move.to_square] = static_cast<Piece>(move.promotion + Knight_with_color<color>());
+                set_piece(move.to_square, static_cast<Piece>(static_cast<int>(move.promotion) + Knight_with_color<color>()));
                 break;
             case SP_castling:
                 do_rook_castling<color>(move.to_square);
-                table[move.to_square] = King_with_color<color>();
+                set_piece(move.to_square, King_with_color<color>());
                 break;
             case SP_en_passant:
                 do_en_passant_remove<color>(move.to_square);
-                table[move.to_square] = Pawn_with_color<color>();
+                set_piece(move.to_square, Pawn_with_color<color>());
             }
-            table[move.from_square] = No_Piece;
+            set_piece(move.from_square, No_Piece);
             return accumulator;
         }
 
         template<Color color>
         inline void undo_rook_castling(const int id){
             if(id == short_castling_square<color>()){
-                table[short_castling_rook_from_square<color>()] = Rook_with_color<color>();
-                table[short_castling_rook_to_square<color>()] = No_Piece;
+                set_piece(short_castling_rook_from_square<color>(), Rook_with_color<color>());
+                set_piece(short_castling_rook_to_square<color>(), No_Piece);
             }   
             else{
-                table[long_castling_rook_from_square<color>()] = Rook_with_color<color>();
-                table[long_castling_rook_to_square<color>()] = No_Piece;
+                set_piece(long_castling_rook_from_square<color>(), Rook_with_color<color>());
+                set_piece(long_castling_rook_to_square<color>(), No_Piece);
             }
         }
 
         template<Color color>
         inline void undo_en_passant_remove(const int id){
             if constexpr(color)
-                table[id - 8] = Pawn_with_color<change_color(color)>();
+                set_piece(id - 8, Pawn_with_color<change_color(color)>());
             else
-                table[id + 8] = Pawn_with_color<change_color(color)>();
+                set_piece(id + 8, Pawn_with_color<change_color(color)>());
         }
 
         template<Color color>
         inline void unstable_undo_move(const Move_full_info move, const Accumulator accumulator){
+            MAESTRO_PROFILE_SCOPE(Prof_undo_move);
             #ifdef MAESTRO_DEBUG
             /// TODO: write checks
             #endif
             turn = static_cast<Color>(!turn);
 
-            table[move.from_square] = table[move.to_square];
+            set_piece(move.from_square, table[move.to_square]);
             switch (move.special)
             {
             case SP_castling:
                 undo_rook_castling<color>(move.to_square);
-                table[move.to_square] = King_with_color<color>();
+                set_piece(move.to_square, King_with_color<color>());
                 break;
             case SP_en_passant:
                 undo_en_passant_remove<color>(move.to_square);
                 //table[move.to_square] = Pawn_with_color<color>();
                 break;
             case SP_Promotion:
-                table[move.from_square] = Pawn_with_color<color>();
+                set_piece(move.from_square, Pawn_with_color<color>());
             }
-            table[move.to_square] = static_cast<Piece>(accumulator.piece_to_revive);
+            set_piece(move.to_square, static_cast<Piece>(accumulator.piece_to_revive));
             restore_info(accumulator);
         }
 
@@ -323,17 +387,17 @@ namespace chess{
         template<Color clr>
         inline void remove_king(){
             if constexpr(clr)
-                table[white_king_position] = No_Piece;
+                set_piece(white_king_position, No_Piece);
             else
-                table[black_king_position] = No_Piece;
+                set_piece(black_king_position, No_Piece);
         }
 
         template<Color clr>
         inline void restore_king(){
             if constexpr(clr)
-                table[white_king_position] = W_King;
+                set_piece(white_king_position, W_King);
             else
-                table[black_king_position] = B_King;
+                set_piece(black_king_position, B_King);
         }
 
 
@@ -371,7 +435,7 @@ namespace chess{
 
 
 
-        inline std::pair<int, int> eval_square(int id){
+        inline std::pair<int, int> eval_square(int id)const{
             if(table[id] == No_Piece)
                 return {0, 0};
             Piece piece = table[id];
@@ -384,17 +448,71 @@ namespace chess{
         
 
         
-        inline int eval_position(){
-            int eval_midlegame = 0, eval_endgame = 0, midlegame_phase = 0;
-            
+        template<Color color>
+        inline u64 get_pawns()const{
+            #ifdef MAESTRO_HYBRID
+            return bitboards[Pawn_with_color<color>()];
+            #else
+            u64 pawns = 0;
+            for(int i = 8; i < 56; ++i){
+                if(table[i] == Pawn_with_color<color>())
+                    pawns |= bit_at(i);
+            }
+            return pawns;
+            #endif
+        }
+
+        /// pawn_table caches the structure by pawn_key, nullptr evaluates it every time
+        inline PawnScore eval_pawns(PawnHashTable *pawn_table = nullptr){
+            const auto compute = [this](){ return eval_pawn_structure(get_pawns<White>(), get_pawns<Black>()); };
+            if(pawn_table != nullptr)
+                return pawn_table->probe(pawn_key, compute);
+            return compute();
+        }
+
+        /// material and squares as a make_score() pair, and the phase, of the whole board:
+        /// 8 squares per gather with AVX2, piece by piece over the bitboards with MAESTRO_HYBRID
+        inline std::pair<int, int> eval_tables()const{
+            #if defined(__AVX2__)
+            __m256i score = _mm256_setzero_si256(), phase = _mm256_setzero_si256();
+            __m256i squares = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            for(int i = 0; i < 64; i += 8){
+                const __m256i pieces = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(table.data() + i));
+                score = _mm256_add_epi32(score, _mm256_i32gather_epi32(pesto_scores.data(), _mm256_add_epi32(_mm256_slli_epi32(pieces, 6), squares), 4));
+                phase = _mm256_add_epi32(phase, _mm256_i32gather_epi32(phase_table, pieces, 4));
+                squares = _mm256_add_epi32(squares, _mm256_set1_epi32(8));
+            }
+            // both sums in one horizontal pass, the scores in the low lanes and the phases in the high ones
+            const __m256i pairs = _mm256_hadd_epi32(score, phase);
+            const __m256i quads = _mm256_hadd_epi32(pairs, pairs);
+            const __m128i sums = _mm_add_epi32(_mm256_castsi256_si128(quads), _mm256_extracti128_si256(quads, 1));
+            return {_mm_cvtsi128_si32(sums), _mm_extract_epi32(sums, 1)};
+            #elif defined(MAESTRO_HYBRID)
+            int score = 0, phase = 0;
+            for(int piece = W_Pawn; piece <= B_King; ++piece){
+                for(u64 pieces = bitboards[piece]; pieces != 0; pieces &= pieces - 1)
+                    score += pesto_scores[piece * 64 + std::countr_zero(pieces)];
+                phase += std::popcount(bitboards[piece]) * phase_table[piece];
+            }
+            return {score, phase};
+            #else
+            int score = 0, phase = 0;
             for(int i = 0; i < 64; ++i){
-                std::pair<int, int> square_eval{eval_square(i)};
+                score += pesto_scores[table[i] * 64 + i];
+                phase += phase_table[table[i]];
+            }
+            return {score, phase};
+            #endif
+        }
 
-                eval_midlegame += material_midlegame[table[i]] + square_eval.first;
-                eval_endgame += material_endgame[table[i]] + square_eval.second;
+        inline int eval_position(PawnHashTable *pawn_table = nullptr){
+            MAESTRO_PROFILE_SCOPE(Prof_eval);
+            const auto [score, phase] = eval_tables();
+            int eval_midlegame = score_midlegame(score), eval_endgame = score_endgame(score), midlegame_phase = phase;
 
-                midlegame_phase += phase_table[table[i]];
-            }
+            const PawnScore pawns = eval_pawns(pawn_table);
+            eval_midlegame += pawns.midlegame;
+            eval_endgame += pawns.endgame;
 
             if(midlegame_phase > 24)
                 midlegame_phase = 24;
@@ -405,11 +523,11 @@ namespace chess{
         }
 
         template<Color color>
-        inline int eval(){
+        inline int eval(PawnHashTable *pawn_table = nullptr){
             if constexpr(color)
-                return eval_position();
+                return eval_position(pawn_table);
             else
-                return -eval_position();
+                return -eval_position(pawn_table);
         }
 
 
@@ -444,6 +562,13 @@ namespace chess{
 
 
 
+        u64 compute_pawn_key()const{
+            u64 key = 0;
+            for(int i = 0; i < 64; ++i)
+                key ^= pawn_zobrist_hashtable[i][table[i]];
+            return key;
+        }
+
         template<Color color>
         inline void do_rook_hashing(const int id, u64 &hash){
             if(id == short_castling_square<color>()){
@@ -516,7 +641,7 @@ namespace chess{
                 hash ^= zobrist_hashtable[move.to_square][table[move.from_square]];
                 break;
             case SP_Promotion:
-                hash ^= zobrist_hashtable[move.to_square][move.promotion + Knight_with_color<color>()];
+                hash ^= zobrist_hashtable[move.to_square][static_cast<int>(move.promotion) + Knight_with_color<color>()];
                 break;
             case SP_castling:
                 do_rook_hashing<color>(move.to_square, hash);
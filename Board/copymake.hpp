@@ -0,0 +1,101 @@
+#pragma once
+#include "board.hpp"
+#include <immintrin.h>
+
+namespace chess{
+
+    /// Everything needed to bring a Board back, packed into one cache line.
+    /// The mailbox is stored as 4 bitboards, bit b of a square in quad[b] is bit b of its piece.
+    struct alignas(64) CompactBoard
+    {
+        static constexpr u64 bytes_low_bit = 0x0101010101010101ull;
+
+        types::array<u64, 4> quad;
+        u64 pawn_key;
+        u16 fifty_moves_rule, total_moves;
+        u8 castl_rights, white_king_position, black_king_position, en_passant;
+        Color turn;
+
+        inline void save(const Board &board){
+            #ifdef MAESTRO_HYBRID
+            // No_Piece is 0b1100, so the empty squares go to quad[2] and quad[3]
+            quad[0] = board.bitboards[W_Knight] | board.bitboards[W_Rook] | board.bitboards[W_King] |
+                      board.bitboards[B_Knight] | board.bitboards[B_Rook] | board.bitboards[B_King];
+            quad[1] = board.bitboards[W_Bishop] | board.bitboards[W_Rook] | board.bitboards[B_Pawn] |
+                      board.bitboards[B_Knight] | board.bitboards[B_Queen] | board.bitboards[B_King];
+            quad[2] = board.bitboards[W_Queen] | board.bitboards[W_King] | board.bitboards[B_Pawn] |
+                      board.bitboards[B_Knight] | board.bitboards[No_Piece];
+            quad[3] = board.bitboards[B_Bishop] | board.bitboards[B_Rook] | board.bitboards[B_Queen] |
+                      board.bitboards[B_King] | board.bitboards[No_Piece];
+            #else
+            quad = {0, 0, 0, 0};
+            for(int rank = 0; rank < 8; ++rank){
+                // one piece per byte, then the same bit of every byte at once
+                u64 pieces = 0;
+                for(int file = 0; file < 8; ++file){
+                    pieces |= static_cast<u64>(board.table[rank * 8 + file]) << (file * 8);
+                }
+                for(int b = 0; b < 4; ++b){
+                    quad[b] |= _pext_u64(pieces, bytes_low_bit << b) << (rank * 8);
+                }
+            }
+            #endif
+            pawn_key = board.pawn_key;
+            fifty_moves_rule = board.fifty_moves_rule;
+            total_moves = board.total_moves;
+            castl_rights = board.castl_rights;
+            white_king_position = board.white_king_position;
+            black_king_position = board.black_king_position;
+            en_passant = board.en_passant;
+            turn = board.turn;
+        }
+
+        inline void restore(Board &board)const{
+            for(int rank = 0; rank < 8; ++rank){
+                u64 pieces = 0;
+                for(int b = 0; b < 4; ++b){
+                    pieces |= _pdep_u64((quad[b] >> (rank * 8)) & 0xff, bytes_low_bit << b);
+                }
+                for(int file = 0; file < 8; ++file){
+                    board.table[rank * 8 + file] = static_cast<Piece>((pieces >> (file * 8)) & 0xff);
+                }
+            }
+            #ifdef MAESTRO_HYBRID
+            for(int piece = 0; piece <= No_Piece; ++piece){
+                board.bitboards[piece] = (piece & 1 ? quad[0] : ~quad[0]) & (piece & 2 ? quad[1] : ~quad[1]) &
+                                         (piece & 4 ? quad[2] : ~quad[2]) & (piece & 8 ? quad[3] : ~quad[3]);
+            }
+            #endif
+            board.pawn_key = pawn_key;
+            board.fifty_moves_rule = fifty_moves_rule;
+            board.total_moves = total_moves;
+            board.castl_rights = static_cast<CastlingRights>(castl_rights);
+            board.white_king_position = static_cast<Square>(white_king_position);
+            board.black_king_position = static_cast<Square>(black_king_position);
+            board.en_passant = static_cast<Square>(en_passant);
+            board.turn = turn;
+        }
+    };
+
+    static_assert(sizeof(CompactBoard) == 64);
+
+    /// copy-make: push before the move, pop instead of the undo
+    template<uint _size>
+    class BoardStack
+    {
+    private:
+        types::array<CompactBoard, _size> stack;
+        uint count = 0;
+
+    public:
+        inline void push(const Board &board){
+            stack[count++].save(board);
+        }
+
+        inline void pop(Board &board){
+            stack[--count].restore(board);
+        }
+
+        inline uint size()const{ return count; }
+    };
+}
@@ -1,24 +1,25 @@
 #pragma once
-#include <random>
 #include"../types.hpp"
 
 namespace chess{
-    constexpr int seed = 1952515;
-    std::mt19937 mt(seed);
+    constexpr u64 seed = 1952515;
     
-    // Generates a Random number from 0 to 2^64-1
-    u64 randomInt()
+    // splitmix64 over the key index, constexpr so every key is known at compile time
+    // and there is no generator state to run at startup
+    constexpr u64 random_at(const u64 index)
     {
-        std::uniform_int_distribution<u64> dist(0, UINT64_MAX);
-        return dist(mt);
+        u64 z = seed + (index + 1) * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
     }
 
-    types::array<types::array<u64, 12>, 64> gen_zobrist(){
+    consteval types::array<types::array<u64, 12>, 64> gen_zobrist(){
         types::array<types::array<u64, 12>, 64> zobrist;
 
         for(int i = 0; i < 64; ++i){
             for(int j = 0; j < 12; ++j){
-                zobrist[i][j] = randomInt();
+                zobrist[i][j] = random_at(i * 12 + j);
             }
         }
         return zobrist;
@@ -26,23 +27,23 @@ namespace chess{
 
 
     
-    types::array<u64, 8> gen_en_passant_files_hash(){
+    consteval types::array<u64, 8> gen_en_passant_files_hash(){
         types::array<u64, 8> en_passant_hash;
 
         for(int i = 0; i < 8; ++i){
-            en_passant_hash[i] = randomInt();
+            en_passant_hash[i] = random_at(773 + i);
         }
         return en_passant_hash;
     }
 
 
-    types::array<types::array<u64, 12>, 64> zobrist_hashtable{gen_zobrist()};
+    constexpr types::array<types::array<u64, 12>, 64> zobrist_hashtable{gen_zobrist()};
 
-    u64 black_side_to_move_hash{randomInt()};
-    u64 White_OO_hash{randomInt()};
-    u64 White_OOO_hash{randomInt()};
-    u64 Black_OO_hash{randomInt()};
-    u64 Black_OOO_hash{randomInt()};
+    constexpr u64 black_side_to_move_hash{random_at(768)};
+    constexpr u64 White_OO_hash{random_at(769)};
+    constexpr u64 White_OOO_hash{random_at(770)};
+    constexpr u64 Black_OO_hash{random_at(771)};
+    constexpr u64 Black_OOO_hash{random_at(772)};
 
     template<Color clr>
     constexpr u64 short_castling_hash_with_color(){
@@ -60,5 +61,19 @@ namespace chess{
             return Black_OOO_hash;
     }
 
-    types::array<u64, 8> en_passant_files_hash {gen_en_passant_files_hash()};
+    constexpr types::array<u64, 8> en_passant_files_hash {gen_en_passant_files_hash()};
+
+    // the pawn keys of zobrist_hashtable, 0 for every other piece and for No_Piece,
+    // so a square write updates the pawn key without a branch
+    consteval types::array<types::array<u64, 13>, 64> gen_pawn_zobrist(){
+        types::array<types::array<u64, 13>, 64> pawn_zobrist{};
+
+        for(int i = 0; i < 64; ++i){
+            pawn_zobrist[i][W_Pawn] = zobrist_hashtable[i][W_Pawn];
+            pawn_zobrist[i][B_Pawn] = zobrist_hashtable[i][B_Pawn];
+        }
+        return pawn_zobrist;
+    }
+
+    constexpr types::array<types::array<u64, 13>, 64> pawn_zobrist_hashtable{gen_pawn_zobrist()};
 }
@@ -0,0 +1,356 @@
+#pragma once
+#include "board.hpp"
+#include <immintrin.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace chess{
+
+    /// HalfKP by default: every perspective sees its own king square times the other 10 pieces on 64 squares,
+    /// -DMAESTRO_HALFKA adds both kings as pieces (12 planes). Black looks at the board mirrored vertically.
+    #ifdef MAESTRO_HALFKA
+    constexpr int nnue_planes = 12;
+    #else
+    constexpr int nnue_planes = 10;
+    #endif
+    constexpr int nnue_inputs = 64 * nnue_planes * 64;
+    constexpr int nnue_hidden = 256;
+    /// the hidden layer is clipped to [0, nnue_clip] and fed to the output as u8
+    constexpr int nnue_clip = 127;
+    /// the output layer sums to centipawns times this
+    constexpr int nnue_output_divisor = 64;
+
+    /// the input row of a piece seen from perspective, -1 for a king in HalfKP
+    template<Color perspective>
+    constexpr int nnue_feature(const int king, const int square, const Piece piece){
+        const int type = piece % 6;
+        const bool own = (piece < B_Pawn) == static_cast<bool>(perspective);
+        #ifdef MAESTRO_HALFKA
+        const int plane = type + (own ? 0 : 6);
+        #else
+        if(type == W_King)
+            return -1;
+        const int plane = type + (own ? 0 : 5);
+        #endif
+        constexpr int flip = perspective ? 0 : 56;
+        return ((king ^ flip) * nnue_planes + plane) * 64 + (square ^ flip);
+    }
+
+    // out = in + the added rows - the removed rows
+    inline void nnue_update_scalar(i16 *out, const i16 *in, const i16 *const *added, const int added_count,
+                                   const i16 *const *removed, const int removed_count){
+        for(int i = 0; i < nnue_hidden; ++i){
+            int value = in[i];
+            for(int j = 0; j < added_count; ++j)
+                value += added[j][i];
+            for(int j = 0; j < removed_count; ++j)
+                value -= removed[j][i];
+            out[i] = static_cast<i16>(value);
+        }
+    }
+
+    // clipped hidden layer of both perspectives, side to move first, times the output weights
+    inline int nnue_output_scalar(const i16 *us, const i16 *them, const i8 *weights){
+        int sum = 0;
+        for(int i = 0; i < nnue_hidden; ++i){
+            sum += std::clamp<int>(us[i], 0, nnue_clip) * weights[i];
+            sum += std::clamp<int>(them[i], 0, nnue_clip) * weights[nnue_hidden + i];
+        }
+        return sum;
+    }
+
+#ifdef __AVX2__
+    inline void nnue_update(i16 *out, const i16 *in, const i16 *const *added, const int added_count,
+                            const i16 *const *removed, const int removed_count){
+        for(int i = 0; i < nnue_hidden; i += 16){
+            __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+            for(int j = 0; j < added_count; ++j)
+                value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added[j] + i)));
+            for(int j = 0; j < removed_count; ++j)
+                value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed[j] + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), value);
+        }
+    }
+
+    inline int nnue_output_half(const i16 *values, const i8 *weights, __m256i sum){
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i clip = _mm256_set1_epi16(nnue_clip);
+        const __m256i ones = _mm256_set1_epi16(1);
+        for(int i = 0; i < nnue_hidden; i += 32){
+            const __m256i low = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)), zero), clip);
+            const __m256i high = _mm256_min_epi16(_mm256_max_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + 16)), zero), clip);
+            // packus works per 128-bit lane, the permute puts the 32 bytes back in order
+            const __m256i clipped = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0b11'01'10'00);
+            // u8 * i8 pairs fit in i16 as long as nnue_clip * 127 * 2 does
+            const __m256i products = _mm256_maddubs_epi16(clipped, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+        }
+        const __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        const __m128i quarter = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0b01'00'11'10));
+        return _mm_cvtsi128_si32(_mm_add_epi32(quarter, _mm_shuffle_epi32(quarter, 0b10'11'00'01)));
+    }
+
+    inline int nnue_output(const i16 *us, const i16 *them, const i8 *weights){
+        return nnue_output_half(us, weights, _mm256_setzero_si256()) + nnue_output_half(them, weights + nnue_hidden, _mm256_setzero_si256());
+    }
+#else
+    inline void nnue_update(i16 *out, const i16 *in, const i16 *const *added, const int added_count,
+                            const i16 *const *removed, const int removed_count){
+        nnue_update_scalar(out, in, added, added_count, removed, removed_count);
+    }
+
+    inline int nnue_output(const i16 *us, const i16 *them, const i8 *weights){
+        return nnue_output_scalar(us, them, weights);
+    }
+#endif
+
+    struct NnueHeader{
+        char magic[4];
+        u32 planes;
+        u32 hidden;
+        i32 output_bias;
+    };
+    static_assert(sizeof(NnueHeader) == 16);
+
+    constexpr char nnue_magic[4] = {'M', 'N', 'N', '1'};
+
+    /// The weights, as stored after the header (little endian):
+    /// i16 feature weights [nnue_inputs][nnue_hidden], i16 feature biases [nnue_hidden],
+    /// i8 output weights [2][nnue_hidden] for the side to move and the other one.
+    class NnueNetwork{
+    private:
+        std::vector<i16> feature_weights;
+        std::vector<i16> feature_biases;
+        std::vector<i8> output_weights;
+        i32 output_bias = 0;
+
+    public:
+        inline bool is_loaded()const{
+            return !feature_weights.empty();
+        }
+
+        /// false leaves the network empty, the file has to be of the same feature set and size
+        bool load(const char *path){
+            feature_weights.clear();
+            FILE *file = fopen(path, "rb");
+            if(file == nullptr)
+                return false;
+            NnueHeader header;
+            std::vector<i16> weights(size_t(nnue_inputs) * nnue_hidden), biases(nnue_hidden);
+            std::vector<i8> output(2 * nnue_hidden);
+            const bool read = (fread(&header, sizeof(header), 1, file) == 1) && (std::memcmp(header.magic, nnue_magic, 4) == 0) &&
+                              (header.planes == nnue_planes) && (header.hidden == nnue_hidden) &&
+                              (fread(weights.data(), sizeof(i16), weights.size(), file) == weights.size()) &&
+                              (fread(biases.data(), sizeof(i16), biases.size(), file) == biases.size()) &&
+                              (fread(output.data(), sizeof(i8), output.size(), file) == output.size()) && (fgetc(file) == EOF);
+            fclose(file);
+            if(!read)
+                return false;
+            feature_weights = std::move(weights);
+            feature_biases = std::move(biases);
+            output_weights = std::move(output);
+            output_bias = header.output_bias;
+            return true;
+        }
+
+        bool save(const char *path)const{
+            if(!is_loaded())
+                return false;
+            FILE *file = fopen(path, "wb");
+            if(file == nullptr)
+                return false;
+            NnueHeader header{{}, nnue_planes, nnue_hidden, output_bias};
+            std::memcpy(header.magic, nnue_magic, 4);
+            const bool written = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+                                 (fwrite(feature_weights.data(), sizeof(i16), feature_weights.size(), file) == feature_weights.size()) &&
+                                 (fwrite(feature_biases.data(), sizeof(i16), feature_biases.size(), file) == feature_biases.size()) &&
+                                 (fwrite(output_weights.data(), sizeof(i8), output_weights.size(), file) == output_weights.size());
+            return (fclose(file) == 0) && written;
+        }
+
+        /// small random weights, for testing and timing the evaluator, it does not play chess
+        void randomize(const u64 seed){
+            std::mt19937_64 random(seed);
+            std::uniform_int_distribution<int> feature(-16, 16), bias(0, 64), output(-64, 64);
+            feature_weights.resize(size_t(nnue_inputs) * nnue_hidden);
+            feature_biases.resize(nnue_hidden);
+            output_weights.resize(2 * nnue_hidden);
+            for(i16 &weight : feature_weights)
+                weight = static_cast<i16>(feature(random));
+            for(i16 &weight : feature_biases)
+                weight = static_cast<i16>(bias(random));
+            for(i8 &weight : output_weights)
+                weight = static_cast<i8>(output(random));
+            output_bias = 0;
+        }
+
+        inline const i16* row(const int feature)const{
+            return feature_weights.data() + size_t(feature) * nnue_hidden;
+        }
+
+        inline const i16* biases()const{
+            return feature_biases.data();
+        }
+
+        /// centipawns for the side whose hidden layer is us
+        inline int output(const i16 *us, const i16 *them)const{
+            return (output_bias + nnue_output(us, them, output_weights.data())) / nnue_output_divisor;
+        }
+
+        inline int output_scalar(const i16 *us, const i16 *them)const{
+            return (output_bias + nnue_output_scalar(us, them, output_weights.data())) / nnue_output_divisor;
+        }
+    };
+
+    /// the hidden layer of both perspectives, indexed by Color
+    struct alignas(32) NnueAccumulator{
+        types::array<types::array<i16, nnue_hidden>, 2> values;
+        types::array<bool, 2> computed;
+    };
+
+    /// what a move changed on the board, a king move of a color makes its perspective start over
+    struct NnueDirty{
+        u8 added_count, removed_count;
+        types::array<u8, 2> added_squares, removed_squares;
+        types::array<Piece, 2> added_pieces, removed_pieces;
+        types::array<bool, 2> refresh;
+    };
+
+    /// One accumulator per ply. push records the pieces a move changes and pop drops the ply,
+    /// the accumulators are only brought up to date when a position is evaluated, from the
+    /// nearest computed ply, or from scratch after a king move of that perspective.
+    template<int max_ply>
+    class NnueStack{
+    private:
+        const NnueNetwork *network = nullptr;
+        std::vector<NnueAccumulator> accumulators = std::vector<NnueAccumulator>(max_ply + 1);
+        types::array<NnueDirty, max_ply + 1> dirty;
+        int ply = 0;
+
+        template<Color perspective>
+        void refresh(const Board &brd, NnueAccumulator &accumulator)const{
+            const int king = brd.get_king_position<perspective>();
+            const i16 *rows[32];
+            int count = 0;
+            i16 *values = accumulator.values[perspective].data();
+            std::copy(network->biases(), network->biases() + nnue_hidden, values);
+            for(int i = 0; i < 64; ++i){
+                if(brd[i] == No_Piece)
+                    continue;
+                const int feature = nnue_feature<perspective>(king, i, brd[i]);
+                if(feature >= 0)
+                    rows[count++] = network->row(feature);
+                if(count == 32){
+                    nnue_update(values, values, rows, count, nullptr, 0);
+                    count = 0;
+                }
+            }
+            nnue_update(values, values, rows, count, nullptr, 0);
+            accumulator.computed[perspective] = true;
+        }
+
+        template<Color perspective>
+        void update(const Board &brd){
+            int from = ply;
+            while(!accumulators[from].computed[perspective]){
+                if((from == 0) || dirty[from].refresh[perspective]){
+                    refresh<perspective>(brd, accumulators[ply]);
+                    return;
+                }
+                --from;
+            }
+            // no king move of this perspective on the way, its king square is the current one
+            const int king = brd.get_king_position<perspective>();
+            for(int i = from + 1; i <= ply; ++i){
+                const NnueDirty &change = dirty[i];
+                const i16 *added[2], *removed[2];
+                int added_count = 0, removed_count = 0;
+                for(int j = 0; j < change.added_count; ++j){
+                    const int feature = nnue_feature<perspective>(king, change.added_squares[j], change.added_pieces[j]);
+                    if(feature >= 0)
+                        added[added_count++] = network->row(feature);
+                }
+                for(int j = 0; j < change.removed_count; ++j){
+                    const int feature = nnue_feature<perspective>(king, change.removed_squares[j], change.removed_pieces[j]);
+                    if(feature >= 0)
+                        removed[removed_count++] = network->row(feature);
+                }
+                nnue_update(accumulators[i].values[perspective].data(), accumulators[i - 1].values[perspective].data(),
+                            added, added_count, removed, removed_count);
+                accumulators[i].computed[perspective] = true;
+            }
+        }
+
+    public:
+        /// nullptr turns the network off
+        void set_network(const NnueNetwork *nnue_network){
+            network = (nnue_network != nullptr) && nnue_network->is_loaded() ? nnue_network : nullptr;
+        }
+
+        inline bool enabled()const{
+            return network != nullptr;
+        }
+
+        /// brd becomes ply 0
+        void reset(const Board &brd){
+            ply = 0;
+            refresh<White>(brd, accumulators[0]);
+            refresh<Black>(brd, accumulators[0]);
+        }
+
+        /// before brd makes the move
+        template<Color clr>
+        inline void push(const Board &brd, const Move_full_info move){
+            NnueDirty &change = dirty[++ply];
+            accumulators[ply].computed = {false, false};
+            const Piece moved = brd[move.from_square];
+            change.refresh[change_color(clr)] = false;
+            change.refresh[clr] = moved == King_with_color<clr>();
+            change.removed_squares[0] = move.from_square;
+            change.removed_pieces[0] = moved;
+            change.removed_count = 1;
+            change.added_squares[0] = move.to_square;
+            change.added_pieces[0] = (move.special == SP_Promotion) ? static_cast<Piece>(static_cast<int>(move.promotion) + Knight_with_color<clr>()) : moved;
+            change.added_count = 1;
+            if(brd[move.to_square] != No_Piece){
+                change.removed_squares[1] = move.to_square;
+                change.removed_pieces[1] = brd[move.to_square];
+                change.removed_count = 2;
+            }
+            else if(move.special == SP_en_passant){
+                change.removed_squares[1] = clr ? move.to_square - 8 : move.to_square + 8;
+                change.removed_pieces[1] = Pawn_with_color<change_color(clr)>();
+                change.removed_count = 2;
+            }
+            else if(move.special == SP_castling){
+                const bool short_castling = move.to_square == short_castling_square<clr>();
+                change.removed_squares[1] = short_castling ? short_castling_rook_from_square<clr>() : long_castling_rook_from_square<clr>();
+                change.removed_pieces[1] = Rook_with_color<clr>();
+                change.removed_count = 2;
+                change.added_squares[1] = short_castling ? short_castling_rook_to_square<clr>() : long_castling_rook_to_square<clr>();
+                change.added_pieces[1] = Rook_with_color<clr>();
+                change.added_count = 2;
+            }
+        }
+
+        /// after the move is taken back
+        inline void pop(){
+            --ply;
+        }
+
+        /// centipawns for clr, the side to move of brd
+        template<Color clr>
+        inline int evaluate(const Board &brd){
+            MAESTRO_PROFILE_SCOPE(Prof_nnue_eval);
+            update<White>(brd);
+            update<Black>(brd);
+            return network->output(accumulators[ply].values[clr].data(), accumulators[ply].values[change_color(clr)].data());
+        }
+
+        inline const NnueAccumulator& get_accumulator()const{
+            return accumulators[ply];
+        }
+    };
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "position.hpp"
+#include <bit>
+#include <span>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess{
+
+    /// Fixed size position record for datasets.
+    /// The pieces are stored one nibble each in the order of the occupied squares, A1 first.
+    struct PackedPosition
+    {
+        u64 occupancy;
+        types::array<u8, 16> pieces;
+        // bits 0-3 castling rights, bit 7 the side to move
+        u8 state;
+        u8 en_passant;
+        u16 fifty_moves_rule;
+        u16 total_moves;
+        // free for the dataset, an eval or a game result
+        int16_t score;
+
+        /// false when the position has more than 32 pieces
+        template<class PieceAt>
+        inline bool encode(const PieceAt &piece_at, const u64 occupied, const Color turn, const CastlingRights castling,
+                           const Square en_passant_square, const int fifty, const int total, const int16_t label = 0){
+            if(std::popcount(occupied) > 32)
+                return false;
+            occupancy = occupied;
+            pieces.fill(0);
+            int count = 0;
+            for(u64 mask = occupied; mask != 0; mask &= mask - 1, ++count){
+                pieces[count / 2] |= piece_at(std::countr_zero(mask)) << ((count % 2) * 4);
+            }
+            state = castling | (turn << 7);
+            en_passant = en_passant_square;
+            fifty_moves_rule = fifty;
+            total_moves = total;
+            score = label;
+            return true;
+        }
+
+        inline bool encode(const Board &brd, const int16_t label = 0){
+            u64 occupied = 0;
+            for(int i = 0; i < 64; ++i){
+                if(brd[i] != No_Piece)
+                    occupied |= bit_at(i);
+            }
+            return encode([&brd](const int id){ return brd[id]; }, occupied, brd.get_turn(), brd.get_castling(),
+                          brd.get_en_passant(), brd.get_fifty_rule(), brd.get_total_moves(), label);
+        }
+
+        inline bool encode(const maestro::Board &brd, const int16_t label = 0){
+            return encode([&brd](const int id){ return static_cast<Piece>(brd.mailbox[id]); }, brd.Not_free,
+                          static_cast<Color>(brd.who_to_move), static_cast<CastlingRights>(brd.castle_rights),
+                          static_cast<Square>(brd.en_passant_take_square), brd.fifty_moves_rule, brd.move_number, label);
+        }
+
+        /// the record holds no checks of its own, it is trusted like the file it came from
+        inline void decode(FenFields &fields)const{
+            fields.pieces.fill(No_Piece);
+            int count = 0;
+            for(u64 mask = occupancy; mask != 0; mask &= mask - 1, ++count){
+                fields.pieces[std::countr_zero(mask)] = static_cast<Piece>((pieces[count / 2] >> ((count % 2) * 4)) & 0xf);
+            }
+            fields.turn = static_cast<Color>(state >> 7);
+            fields.castling = static_cast<CastlingRights>(state & 0xf);
+            fields.en_passant = static_cast<Square>(en_passant);
+            fields.fifty_moves_rule = fifty_moves_rule;
+            fields.total_moves = total_moves;
+            fields.operations = {};
+        }
+
+        inline void decode(Board &brd)const{
+            FenFields fields;
+            decode(fields);
+            load_fen(fields, brd);
+        }
+
+        inline void decode(maestro::Board &brd)const{
+            FenFields fields;
+            decode(fields);
+            load_fen(fields, brd);
+        }
+    };
+
+    static_assert(sizeof(PackedPosition) == 32);
+
+    /// the records are written raw, one after another
+    inline bool write_packed(FILE *file, const std::span<const PackedPosition> records){
+        return fwrite(records.data(), sizeof(PackedPosition), records.size(), file) == records.size();
+    }
+
+    /// Maps a file of records read-only, iterating it copies nothing.
+    class PackedReader
+    {
+    private:
+        const PackedPosition *data = nullptr;
+        size_t count = 0;
+        size_t mapped_size = 0;
+
+    public:
+        explicit PackedReader(const char *path){
+            const int fd = open(path, O_RDONLY);
+            if(fd < 0)
+                return;
+            struct stat info;
+            if((fstat(fd, &info) == 0) && (info.st_size >= static_cast<off_t>(sizeof(PackedPosition)))){
+                mapped_size = info.st_size;
+                void *ptr = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(ptr != MAP_FAILED){
+                    madvise(ptr, mapped_size, MADV_SEQUENTIAL);
+                    data = static_cast<const PackedPosition*>(ptr);
+                    // a torn record at the end is ignored
+                    count = mapped_size / sizeof(PackedPosition);
+                }
+            }
+            close(fd);
+        }
+
+        PackedReader(const PackedReader&) = delete;
+        PackedReader& operator=(const PackedReader&) = delete;
+
+        ~PackedReader(){
+            if(data != nullptr)
+                munmap(const_cast<PackedPosition*>(data), mapped_size);
+        }
+
+        inline bool is_open()const{ return data != nullptr; }
+        inline size_t size()const{ return count; }
+        inline const PackedPosition& operator[](const size_t id)const{ return data[id]; }
+        inline const PackedPosition* begin()const{ return data; }
+        inline const PackedPosition* end()const{ return data + count; }
+    };
+}
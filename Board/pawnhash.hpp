@@ -0,0 +1,152 @@
+#pragma once
+#include "../types.hpp"
+#include "evaltables.hpp"
+#include <bit>
+#include <vector>
+
+namespace chess{
+
+    struct PawnScore{
+        int midlegame = 0;
+        int endgame = 0;
+    };
+
+    consteval types::array<u64, 8> gen_file_masks(){
+        types::array<u64, 8> files{};
+        for(int i = 0; i < 64; ++i)
+            files[i % 8] |= u64(1) << i;
+        return files;
+    }
+
+    constexpr types::array<u64, 8> file_masks{gen_file_masks()};
+
+    // the files next to each file
+    consteval types::array<u64, 8> gen_adjacent_files_masks(){
+        types::array<u64, 8> adjacent{};
+        for(int file = 0; file < 8; ++file){
+            if(file > 0)
+                adjacent[file] |= file_masks[file - 1];
+            if(file < 7)
+                adjacent[file] |= file_masks[file + 1];
+        }
+        return adjacent;
+    }
+
+    constexpr types::array<u64, 8> adjacent_files_masks{gen_adjacent_files_masks()};
+
+    // squares in front of a pawn on its own and the adjacent files, white first
+    consteval types::array<types::array<u64, 64>, 2> gen_passed_pawn_masks(){
+        types::array<types::array<u64, 64>, 2> masks{};
+        for(int i = 0; i < 64; ++i){
+            const u64 span = file_masks[i % 8] | adjacent_files_masks[i % 8];
+            for(int j = 0; j < 64; ++j){
+                if(j / 8 > i / 8)
+                    masks[White][i] |= span & (u64(1) << j);
+                if(j / 8 < i / 8)
+                    masks[Black][i] |= span & (u64(1) << j);
+            }
+        }
+        return masks;
+    }
+
+    constexpr types::array<types::array<u64, 64>, 2> passed_pawn_masks{gen_passed_pawn_masks()};
+
+    /// doubled and isolated pawns and passed pawns by rank from their own side, white minus black
+    struct PawnCounts{
+        int doubled = 0;
+        int isolated = 0;
+        types::array<int, 8> passed{};
+    };
+
+    constexpr PawnCounts count_pawn_structure(const u64 white_pawns, const u64 black_pawns){
+        PawnCounts counts;
+        for(int file = 0; file < 8; ++file){
+            const int white_count = std::popcount(white_pawns & file_masks[file]);
+            const int black_count = std::popcount(black_pawns & file_masks[file]);
+            counts.doubled += std::max(white_count - 1, 0) - std::max(black_count - 1, 0);
+            counts.isolated += ((white_pawns & adjacent_files_masks[file]) ? 0 : white_count) -
+                               ((black_pawns & adjacent_files_masks[file]) ? 0 : black_count);
+        }
+        for(u64 pawns = white_pawns; pawns != 0; pawns &= pawns - 1){
+            const int id = std::countr_zero(pawns);
+            if((passed_pawn_masks[White][id] & black_pawns) == 0)
+                ++counts.passed[id / 8];
+        }
+        for(u64 pawns = black_pawns; pawns != 0; pawns &= pawns - 1){
+            const int id = std::countr_zero(pawns);
+            if((passed_pawn_masks[Black][id] & white_pawns) == 0)
+                --counts.passed[7 - id / 8];
+        }
+        return counts;
+    }
+
+    /// doubled, isolated and passed pawns, white minus black
+    constexpr PawnScore eval_pawn_structure(const u64 white_pawns, const u64 black_pawns){
+        const PawnCounts counts = count_pawn_structure(white_pawns, black_pawns);
+        PawnScore score{counts.doubled * doubled_pawn_midlegame + counts.isolated * isolated_pawn_midlegame,
+                        counts.doubled * doubled_pawn_endgame + counts.isolated * isolated_pawn_endgame};
+        for(int rank = 0; rank < 8; ++rank){
+            score.midlegame += counts.passed[rank] * passed_pawn_midlegame[rank];
+            score.endgame += counts.passed[rank] * passed_pawn_endgame[rank];
+        }
+        return score;
+    }
+
+    struct PawnEntry{
+        u64 key;
+        i16 midlegame;
+        i16 endgame;
+    };
+
+    /// Pawn structure scores by pawn key, one entry per slot, a new structure replaces the old one.
+    /// The empty table holds key 0 with a zero score, which is the right answer for no pawns.
+    class PawnHashTable{
+    private:
+        std::vector<PawnEntry> entries;
+        u64 mask = 0;
+        u64 probes = 0;
+        u64 hits = 0;
+
+    public:
+        explicit PawnHashTable(const size_t kilobytes = 256){
+            resize(kilobytes);
+        }
+
+        /// rounded down to a power of two entries
+        void resize(const size_t kilobytes){
+            const size_t count = std::bit_floor(std::max<size_t>(kilobytes * 1024 / sizeof(PawnEntry), 1));
+            entries.assign(count, PawnEntry{});
+            mask = count - 1;
+            reset_stats();
+        }
+
+        void clear(){
+            std::fill(entries.begin(), entries.end(), PawnEntry{});
+            reset_stats();
+        }
+
+        /// compute is only called on a miss, it returns the PawnScore of the structure
+        template<class Compute>
+        inline PawnScore probe(const u64 key, const Compute &compute){
+            ++probes;
+            PawnEntry &entry = entries[key & mask];
+            if(entry.key == key){
+                ++hits;
+                return {entry.midlegame, entry.endgame};
+            }
+            const PawnScore score = compute();
+            entry = {key, static_cast<i16>(score.midlegame), static_cast<i16>(score.endgame)};
+            return score;
+        }
+
+        void reset_stats(){
+            probes = 0;
+            hits = 0;
+        }
+
+        inline u64 get_probes()const{ return probes; }
+        inline u64 get_hits()const{ return hits; }
+        inline double hit_rate()const{ return probes ? double(hits) / probes : 0.0; }
+        inline size_t size()const{ return entries.size(); }
+    };
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "evaltables.hpp"
+
+namespace chess{
+
+    /// midlegame and endgame in one int, the endgame in the low 16 bits, so both add up at once
+    constexpr int make_score(const int midlegame, const int endgame){
+        return static_cast<int>(static_cast<unsigned>(midlegame) << 16) + endgame;
+    }
+
+    constexpr int score_midlegame(const int score){
+        return static_cast<i16>(static_cast<unsigned>(score + 0x8000) >> 16);
+    }
+
+    constexpr int score_endgame(const int score){
+        return static_cast<i16>(static_cast<unsigned>(score) & 0xffff);
+    }
+
+    /// material and square tables of every piece, flipped and signed for White, No_Piece is all zeros
+    consteval types::array<int, 13 * 64> gen_pesto_scores(){
+        types::array<int, 13 * 64> scores{};
+        for(int piece = W_Pawn; piece <= B_King; ++piece){
+            for(int id = 0; id < 64; ++id){
+                const bool white = piece < B_Pawn;
+                const int type = piece % 6, square = white ? id ^ 56 : id, sign = white ? 1 : -1;
+                scores[piece * 64 + id] = make_score(material_midlegame[piece] + sign * square_eval_midlegame[type][square],
+                                                     material_endgame[piece] + sign * square_eval_endgame[type][square]);
+            }
+        }
+        return scores;
+    }
+
+    constexpr types::array<int, 13 * 64> pesto_scores{gen_pesto_scores()};
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "board.hpp"
+#include "../MainLogic/fenView.hpp"
+#include "../MainLogic/movegen.hpp"
+#include "../maestro_coreSource/maestro.hpp"
+
+namespace chess{
+
+    inline void load_fen(const FenFields &fields, maestro::Board &brd){
+        brd.clear_boards();
+        for(int i = 0; i < 64; ++i){
+            const Piece piece = fields.pieces[i];
+            if(piece == No_Piece)
+                continue;
+            if(piece_color(piece))
+                brd.put_piece<maestro::Color_White>(static_cast<maestro::Square>(i), static_cast<maestro::Piece>(piece));
+            else
+                brd.put_piece<maestro::Color_Black>(static_cast<maestro::Square>(i), static_cast<maestro::Piece>(piece));
+        }
+        brd.Not_free = brd.White_brd | brd.Black_brd;
+        brd.who_to_move = static_cast<maestro::Color>(fields.turn);
+        brd.castle_rights = static_cast<maestro::CastlingRights>(fields.castling);
+        brd.en_passant_take_square = static_cast<maestro::Square>(fields.en_passant);
+        brd.fifty_moves_rule = fields.fifty_moves_rule;
+        brd.move_number = fields.total_moves;
+    }
+
+    /// the board is left untouched when the FEN is rejected
+    inline FenError parse_fen(const std::string_view fen, maestro::Board &brd){
+        FenFields fields;
+        const FenError error = parse_fen(fen, fields);
+        if(!error)
+            load_fen(fields, brd);
+        return error;
+    }
+
+    /// out needs fen_buffer_size chars
+    inline char *write_fen(char *out, const maestro::Board &brd){
+        return write_fen(out, [&brd](const int id){ return static_cast<Piece>(brd.mailbox[id]); }, static_cast<Color>(brd.who_to_move),
+                         static_cast<CastlingRights>(brd.castle_rights), static_cast<Square>(brd.en_passant_take_square),
+                         brd.fifty_moves_rule, brd.move_number);
+    }
+
+    /// One position in both representations, kept in sync under make/undo.
+    /// The mailbox answers eval, hashing and move generation,
+    /// the bitboards answer attack and occupancy queries.
+    class Position
+    {
+    private:
+        Board board;
+        maestro::Board bitboards;
+
+        // castling, en passant, the side to move and the counters are owned by the mailbox
+        inline void sync_state(){
+            bitboards.castle_rights = static_cast<maestro::CastlingRights>(board.get_castling());
+            bitboards.en_passant_take_square = static_cast<maestro::Square>(board.get_en_passant());
+            bitboards.who_to_move = static_cast<maestro::Color>(board.get_turn());
+            bitboards.fifty_moves_rule = board.get_fifty_rule();
+            bitboards.move_number = board.get_total_moves();
+        }
+
+        static constexpr maestro::Move_full_info to_bitboard_move(const Move_full_info move){
+            return maestro::Move_full_info(move.from_square, move.to_square, move.promotion, move.special);
+        }
+
+    public:
+        Position(){}
+
+        /// both sides are loaded from one parse
+        FenError parse_from_FEN(const std::string_view FEN){
+            FenFields fields;
+            const FenError error = parse_fen(FEN, fields);
+            if(error)
+                return error;
+            load_fen(fields, board);
+            load_fen(fields, bitboards);
+            return error;
+        }
+
+        template<Color color>
+        inline Accumulator make_move(const Move_full_info move){
+            bitboards.make_move<static_cast<maestro::Color>(color)>(to_bitboard_move(move), static_cast<maestro::Piece>(board[move.from_square]));
+            const Accumulator accumulator = board.unstable_make_move<color>(move);
+            sync_state();
+            return accumulator;
+        }
+
+        template<Color color>
+        inline void undo_move(const Move_full_info move, const Accumulator accumulator){
+            board.unstable_undo_move<color>(move, accumulator);
+            bitboards.unmake_move<static_cast<maestro::Color>(color)>(to_bitboard_move(move), static_cast<maestro::Piece>(board[move.from_square]),
+                static_cast<maestro::Piece>(accumulator.piece_to_revive));
+            sync_state();
+        }
+
+        template<Color color>
+        inline PositionState gen_moves(Movelist_ref &list){
+            Movegen generator(board, list);
+            return generator.gen_all_moves<color>();
+        }
+
+        /// squares attacked by the pieces of the color
+        template<Color color>
+        inline u64 attacked_mask(){
+            return bitboards.gen_attacked_mask_by_Color<static_cast<maestro::Color>(color)>();
+        }
+
+        template<Color color>
+        inline bool in_check(){
+            return (attacked_mask<change_color(color)>() & bitboards.My_King<static_cast<maestro::Color>(color)>()) != 0;
+        }
+
+        inline u64 get_occupied()const{ return bitboards.Not_free; }
+
+        template<Color color>
+        inline int eval(){ return board.eval<color>(); }
+
+        inline u64 get_hash(){ return board.get_hash(); }
+
+        inline Color get_turn()const{ return board.get_turn(); }
+        inline const Piece& operator[](const uint id)const{ return board[id]; }
+        inline Board& get_board(){ return board; }
+        inline const maestro::Board& get_bitboards()const{ return bitboards; }
+
+        /// both sides describe the same position
+        bool is_consistent()const{
+            u64 white = 0, black = 0;
+            for(int i = 0; i < 64; ++i){
+                const Piece piece = board[i];
+                if(static_cast<int>(bitboards.mailbox[i]) != piece)
+                    return false;
+                for(int j = 0; j < 12; ++j){
+                    if(contains(bitboards.bit_boards[j], bit_at(i)) != (j == piece))
+                        return false;
+                }
+                if(piece != No_Piece)
+                    (piece_color(piece) ? white : black) |= bit_at(i);
+            }
+            return (white == bitboards.White_brd) && (black == bitboards.Black_brd) && ((white | black) == bitboards.Not_free) &&
+                   (static_cast<int>(bitboards.castle_rights) == board.get_castling()) &&
+                   (static_cast<int>(bitboards.en_passant_take_square) == board.get_en_passant()) &&
+                   (static_cast<bool>(bitboards.who_to_move) == static_cast<bool>(board.get_turn()));
+        }
+    };
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include "movegen.hpp"
+#include "../Board/polyglot.hpp"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess
+{
+    struct PolyglotEntry
+    {
+        u64 key;
+        u16 move;
+        u16 weight;
+        u32 learn;
+    };
+
+    /// Polyglot .bin opening book, mapped read-only.
+    /// Entries are 16 big-endian bytes sorted by key, so a lookup is a binary search over the mapping.
+    class PolyglotBook
+    {
+    private:
+        static constexpr size_t entry_size = 16;
+
+        const u8 *data = nullptr;
+        size_t count = 0;
+        size_t mapped_size = 0;
+
+        static u64 read_u64(const u8 *ptr)
+        {
+            u64 value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return __builtin_bswap64(value);
+        }
+
+        static u32 read_u32(const u8 *ptr)
+        {
+            u32 value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return __builtin_bswap32(value);
+        }
+
+        static u16 read_u16(const u8 *ptr)
+        {
+            u16 value;
+            std::memcpy(&value, ptr, sizeof(value));
+            return __builtin_bswap16(value);
+        }
+
+        inline u64 key_at(const size_t id) const { return read_u64(data + id * entry_size); }
+
+        // Polyglot writes castling as the king taking its own rook
+        template <Color clr>
+        static bool same_move(const Move_full_info move, const int from, int to, const int promotion)
+        {
+            if (move.special == SP_castling)
+            {
+                if (to == short_castling_rook_from_square<clr>())
+                    to = short_castling_square<clr>();
+                else if (to == long_castling_rook_from_square<clr>())
+                    to = long_castling_square<clr>();
+            }
+            if ((move.from_square != from) || (move.to_square != to))
+                return false;
+            if (move.special == SP_Promotion)
+                return move.promotion + 1 == promotion;
+            return promotion == 0;
+        }
+
+    public:
+        PolyglotBook() {}
+
+        explicit PolyglotBook(const char *path)
+        {
+            open(path);
+        }
+
+        PolyglotBook(const PolyglotBook &) = delete;
+        PolyglotBook &operator=(const PolyglotBook &) = delete;
+
+        ~PolyglotBook()
+        {
+            close();
+        }
+
+        bool open(const char *path)
+        {
+            close();
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat info;
+            if ((fstat(fd, &info) == 0) && (info.st_size >= static_cast<off_t>(entry_size)))
+            {
+                mapped_size = info.st_size;
+                void *ptr = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr != MAP_FAILED)
+                {
+                    madvise(ptr, mapped_size, MADV_RANDOM);
+                    data = static_cast<const u8 *>(ptr);
+                    count = mapped_size / entry_size;
+                }
+            }
+            ::close(fd);
+            return is_open();
+        }
+
+        void close()
+        {
+            if (data != nullptr)
+                munmap(const_cast<u8 *>(data), mapped_size);
+            data = nullptr;
+            count = 0;
+            mapped_size = 0;
+        }
+
+        inline bool is_open() const { return data != nullptr; }
+        inline size_t size() const { return count; }
+
+        PolyglotEntry entry(const size_t id) const
+        {
+            const u8 *ptr = data + id * entry_size;
+            return {read_u64(ptr), read_u16(ptr + 8), read_u16(ptr + 10), read_u32(ptr + 12)};
+        }
+
+        /// index of the first entry with the key, size() when there is none
+        size_t find(const u64 key) const
+        {
+            size_t left = 0, right = count;
+            while (left < right)
+            {
+                const size_t mid = left + (right - left) / 2;
+                if (key_at(mid) < key)
+                    left = mid + 1;
+                else
+                    right = mid;
+            }
+            return ((left < count) && (key_at(left) == key)) ? left : count;
+        }
+
+        /// a book move for the position, picked with probability proportional to its weight
+        /// (random is any number, 0 always gives the heaviest move); No_Move when out of book
+        template <Color clr>
+        Move_full_info probe(Board &brd, Movelist_ref list, const u64 random = 0) const
+        {
+            const u64 key = polyglot_hash(brd);
+            const size_t first = find(key);
+            if (first == count)
+                return Move_full_info();
+
+            u64 total_weight = 0;
+            size_t last = first;
+            for (; (last < count) && (key_at(last) == key); ++last)
+                total_weight += entry(last).weight;
+
+            // entries are written heaviest first, a zero random lands on the first one
+            size_t chosen = first;
+            if (total_weight != 0)
+            {
+                u64 pick = random % total_weight;
+                for (; chosen + 1 < last; ++chosen)
+                {
+                    const u64 weight = entry(chosen).weight;
+                    if (pick < weight)
+                        break;
+                    pick -= weight;
+                }
+            }
+
+            const u16 move = entry(chosen).move;
+            const int to = move & 63, from = (move >> 6) & 63, promotion = (move >> 12) & 7;
+            Movegen generator(brd, list);
+            generator.gen_all_moves<clr>();
+            for (Move_full_info *i = list.begin; i != list.end; ++i)
+            {
+                if (same_move<clr>(*i, from, to, promotion))
+                    return *i;
+            }
+            // a key collision or a broken book
+            return Move_full_info();
+        }
+
+        Move_full_info probe(Board &brd, Movelist_ref list, const u64 random = 0) const
+        {
+            return brd.get_turn() ? probe<White>(brd, list, random) : probe<Black>(brd, list, random);
+        }
+    };
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "../types.hpp"
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace chess{
+
+    /// Static evaluations by position hash, lossy and lock-free: every slot is one 64-bit word holding
+    /// the upper half of the key and the score, so readers never see a torn entry and a collision
+    /// in the upper half is the only way to get a wrong score. Safe to share between search threads.
+    class EvalCache{
+    private:
+        std::unique_ptr<std::atomic<u64>[]> entries;
+        size_t count = 0;
+        u64 mask = 0;
+
+        static constexpr u64 key_bits = 0xFFFF'FFFF'0000'0000;
+
+    public:
+        explicit EvalCache(const size_t megabytes = 4){
+            resize(megabytes);
+        }
+
+        /// rounded down to a power of two entries, 0 turns the cache off
+        void resize(const size_t megabytes){
+            count = megabytes ? std::bit_floor(megabytes * 1024 * 1024 / sizeof(u64)) : 0;
+            entries.reset(count ? new std::atomic<u64>[count] : nullptr);
+            mask = count ? count - 1 : 0;
+            clear();
+        }
+
+        void clear(){
+            for(size_t i = 0; i < count; ++i)
+                entries[i].store(0, std::memory_order_relaxed);
+        }
+
+        inline bool enabled()const{
+            return count != 0;
+        }
+
+        inline bool probe(const u64 key, int &score)const{
+            const u64 entry = entries[key & mask].load(std::memory_order_relaxed);
+            if((entry & key_bits) != (key & key_bits))
+                return false;
+            score = static_cast<int32_t>(static_cast<u32>(entry));
+            return true;
+        }
+
+        inline void store(const u64 key, const int score){
+            entries[key & mask].store((key & key_bits) | static_cast<u32>(score), std::memory_order_relaxed);
+        }
+
+        inline size_t size()const{ return count; }
+    };
+}
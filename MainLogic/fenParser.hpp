@@ -1,5 +1,6 @@
 #pragma once
 #include "../Board/board.hpp"
+#include "fenView.hpp"
 
 namespace chess
 {
@@ -44,24 +45,11 @@ namespace chess
             //std::cout << "Total Moves" << "\n";
 
             brd.find_kings();
+            brd.init_bitboards();
         }
         types::string parse_to_Fen(Board &brd){
-            types::string result_fen;
-            result_fen.reserve(95);
-            result_fen += position_to_fen(brd);
-            result_fen += " ";
-            result_fen += turn_to_fen(brd.get_turn());
-            result_fen += " ";
-            result_fen += castle_to_fen(brd);
-            result_fen += " ";
-            result_fen += en_passant_to_fen(brd.get_en_passant());
-            result_fen += " ";
-            result_fen += fifty_moves_to_fen(brd.get_fifty_rule());
-            result_fen += " ";
-            result_fen += total_moves_to_fen(brd.get_total_moves());
-
-            result_fen.shrink_to_fit();
-            return result_fen;
+            char buffer[fen_buffer_size];
+            return types::string(buffer, write_fen(buffer, brd));
         }
 
      private:
@@ -141,94 +129,6 @@ namespace chess
             brd.set_total_moves(moves_total);
         }
 
-        types::string position_to_fen(const Board& brd){
-            types::string position_to_fen = "";
-            position_to_fen.reserve(85);
-            constexpr int board_height = 8;
-            constexpr int board_width = 8;
-
-            for (int height = 0; height < board_height; ++height)
-            {
-                int empty_squares_counter = 0;
-                for (int width = 0; width < board_width; ++width)
-                {
-
-                    const int real_id = real_board_id(width + board_width * height); 
-                    char currentPiece = mapToFen.at(brd[real_id]);
-                    if (currentPiece != '*')
-                    {
-                        if (empty_squares_counter != 0)
-                        {
-                            position_to_fen += empty_squares_counter;
-                            empty_squares_counter = 0;
-                        }
-                        position_to_fen += currentPiece;
-                    }
-                    else
-                    {
-                        empty_squares_counter++;
-
-                        if (empty_squares_counter == board_width)
-                        {
-                            position_to_fen += empty_squares_counter;
-                            empty_squares_counter = 0;
-                        }
-                    }
-                }
-                if (height == 7)
-                    break;
-                position_to_fen += '/';
-            }
-
-            return position_to_fen;
-        }
-        types::string turn_to_fen(Color clr)
-        {
-            if (clr)
-            {
-                return "w";
-            }
-            return "b";
-        }
-        types::string castle_to_fen(const Board& brd){
-            types::string castl_FEN;
-            if(brd.has_castling(White_OO)){
-                castl_FEN += 'K';
-            }
-            if(brd.has_castling(White_OOO)){
-                castl_FEN += 'Q';
-            }
-            if(brd.has_castling(Black_OO)){
-                castl_FEN += 'k';
-            }
-            if(brd.has_castling(Black_OOO)){
-                castl_FEN += 'q';
-            }
-            return castl_FEN;
-        }
-        types::string en_passant_to_fen(Square en_passant)
-        {
-            if(en_passant == No_Square)
-                return "-";
-
-            types::string en_passant_square = "";
-
-            int number_of_square = en_passant / 8 + 1;
-
-            en_passant_square = get_file_from_offest(en_passant % 8);
-            en_passant_square += number_of_square;
-
-            return en_passant_square;
-        }
-        types::string fifty_moves_to_fen(int move)
-        {
-            return std::to_string(move);
-        }
-        types::string total_moves_to_fen(int move)
-        {
-            return std::to_string(move);
-        }
-
         void init()
         {
             fenToMap.insert(std::pair<char, Piece>('r', Piece::B_Rook));
@@ -268,15 +168,6 @@ namespace chess
             #endif
             return id;
         }
-
-        char get_file_from_offest(int offset)
-        {
-            #ifdef MAESTRO_DEBUG
-            if((offset < 0) || (offset > 7))
-                throw std::invalid_argument("Invalid offset: " + offset);
-            #endif
-            return offset + 'a';
-        }
     };
 
     
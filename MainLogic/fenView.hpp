@@ -0,0 +1,348 @@
+#pragma once
+#include <string_view>
+#include <charconv>
+#include "../Board/board.hpp"
+
+namespace chess
+{
+    /// FEN/EPD parser over std::string_view: no allocation, no streams,
+    /// every error carries the offset of the character that broke it.
+    /// write_fen goes the other way, straight into the caller's buffer
+
+    enum FenErrorCode : int
+    {
+        Fen_OK = 0,
+        Fen_missing_field,
+        Fen_bad_piece,
+        Fen_bad_rank,
+        Fen_bad_rank_count,
+        Fen_bad_kings,
+        Fen_pawn_on_last_rank,
+        Fen_bad_turn,
+        Fen_bad_castling,
+        Fen_bad_en_passant,
+        Fen_bad_number
+    };
+
+    constexpr const char *fen_error_message(const FenErrorCode code)
+    {
+        switch (code)
+        {
+        case Fen_OK:
+            return "ok";
+        case Fen_missing_field:
+            return "missing field";
+        case Fen_bad_piece:
+            return "unknown piece";
+        case Fen_bad_rank:
+            return "rank is not 8 squares long";
+        case Fen_bad_rank_count:
+            return "board is not 8 ranks long";
+        case Fen_bad_kings:
+            return "each side needs exactly one king";
+        case Fen_bad_turn:
+            return "side to move is not w or b";
+        case Fen_pawn_on_last_rank:
+            return "pawn on the first or last rank";
+        case Fen_bad_castling:
+            return "bad castling rights";
+        case Fen_bad_en_passant:
+            return "bad en passant square";
+        case Fen_bad_number:
+            return "bad move counter";
+        }
+        return "unknown error";
+    }
+
+    struct FenError
+    {
+        FenErrorCode code = Fen_OK;
+        int position = 0;
+
+        constexpr explicit operator bool() const { return code != Fen_OK; }
+    };
+
+    struct FenFields
+    {
+        std::array<Piece, 64> pieces;
+        Color turn;
+        CastlingRights castling;
+        Square en_passant;
+        int fifty_moves_rule;
+        int total_moves;
+        // whatever follows the position in an EPD line ("bm e4; id ...")
+        std::string_view operations;
+    };
+
+    consteval std::array<Piece, 256> gen_fen_piece_table()
+    {
+        std::array<Piece, 256> table;
+        table.fill(No_Piece);
+        table['P'] = W_Pawn;
+        table['N'] = W_Knight;
+        table['B'] = W_Bishop;
+        table['R'] = W_Rook;
+        table['Q'] = W_Queen;
+        table['K'] = W_King;
+        table['p'] = B_Pawn;
+        table['n'] = B_Knight;
+        table['b'] = B_Bishop;
+        table['r'] = B_Rook;
+        table['q'] = B_Queen;
+        table['k'] = B_King;
+        return table;
+    }
+
+    constexpr std::array<Piece, 256> fen_piece_table{gen_fen_piece_table()};
+
+    constexpr FenError parse_fen(const std::string_view fen, FenFields &fields)
+    {
+        const int size = static_cast<int>(fen.size());
+        int id = 0;
+        auto skip_spaces = [&]()
+        {
+            while ((id < size) && (fen[id] == ' '))
+                ++id;
+        };
+        auto at_field_end = [&]()
+        {
+            return (id >= size) || (fen[id] == ' ');
+        };
+
+        // pieces, from rank 8 down
+        fields.pieces.fill(No_Piece);
+        skip_spaces();
+        if (id >= size)
+            return {Fen_missing_field, id};
+        const int board_start = id;
+        int rank = 7, file = 0, white_kings = 0, black_kings = 0;
+        for (; !at_field_end(); ++id)
+        {
+            const char symb = fen[id];
+            if (symb == '/')
+            {
+                if (file != 8)
+                    return {Fen_bad_rank, id};
+                if (rank == 0)
+                    return {Fen_bad_rank_count, id};
+                --rank;
+                file = 0;
+                continue;
+            }
+            if ((symb >= '1') && (symb <= '8'))
+            {
+                file += symb - '0';
+                if (file > 8)
+                    return {Fen_bad_rank, id};
+                continue;
+            }
+            const Piece piece = fen_piece_table[static_cast<u8>(symb)];
+            if (piece == No_Piece)
+                return {Fen_bad_piece, id};
+            if (file == 8)
+                return {Fen_bad_rank, id};
+            if (((piece == W_Pawn) || (piece == B_Pawn)) && ((rank == 0) || (rank == 7)))
+                return {Fen_pawn_on_last_rank, id};
+            white_kings += (piece == W_King);
+            black_kings += (piece == B_King);
+            fields.pieces[rank * 8 + file++] = piece;
+        }
+        if (file != 8)
+            return {Fen_bad_rank, id};
+        if (rank != 0)
+            return {Fen_bad_rank_count, id};
+        if ((white_kings != 1) || (black_kings != 1))
+            return {Fen_bad_kings, board_start};
+
+        // side to move
+        skip_spaces();
+        if (id >= size)
+            return {Fen_missing_field, id};
+        if ((fen[id] != 'w') && (fen[id] != 'b'))
+            return {Fen_bad_turn, id};
+        fields.turn = (fen[id++] == 'w') ? White : Black;
+        if (!at_field_end())
+            return {Fen_bad_turn, id};
+
+        // castling
+        skip_spaces();
+        if (id >= size)
+            return {Fen_missing_field, id};
+        fields.castling = NO_Castling;
+        if (fen[id] == '-')
+            ++id;
+        else
+        {
+            for (; !at_field_end(); ++id)
+            {
+                CastlingRights right;
+                switch (fen[id])
+                {
+                case 'K':
+                    right = White_OO;
+                    break;
+                case 'Q':
+                    right = White_OOO;
+                    break;
+                case 'k':
+                    right = Black_OO;
+                    break;
+                case 'q':
+                    right = Black_OOO;
+                    break;
+                default:
+                    return {Fen_bad_castling, id};
+                }
+                if (contains(fields.castling, right))
+                    return {Fen_bad_castling, id};
+                fields.castling |= right;
+            }
+        }
+        if (!at_field_end())
+            return {Fen_bad_castling, id};
+
+        // en passant, the square behind a pawn of the side that just moved
+        skip_spaces();
+        if (id >= size)
+            return {Fen_missing_field, id};
+        fields.en_passant = No_Square;
+        if (fen[id] == '-')
+            ++id;
+        else
+        {
+            const char ep_rank = (fields.turn == White) ? '6' : '3';
+            if ((id + 1 >= size) || (fen[id] < 'a') || (fen[id] > 'h') || (fen[id + 1] != ep_rank))
+                return {Fen_bad_en_passant, id};
+            fields.en_passant = static_cast<Square>((fen[id] - 'a') + (fen[id + 1] - '1') * 8);
+            id += 2;
+        }
+        if (!at_field_end())
+            return {Fen_bad_en_passant, id};
+
+        // move counters are optional in EPD, anything else is left for the caller
+        auto parse_number = [&](int &number) -> FenError
+        {
+            number = 0;
+            for (; !at_field_end(); ++id)
+            {
+                if ((fen[id] < '0') || (fen[id] > '9') || (number > 100'000))
+                    return {Fen_bad_number, id};
+                number = number * 10 + (fen[id] - '0');
+            }
+            return {};
+        };
+        fields.fifty_moves_rule = 0;
+        fields.total_moves = 1;
+        skip_spaces();
+        if ((id < size) && (fen[id] >= '0') && (fen[id] <= '9'))
+        {
+            if (const FenError error = parse_number(fields.fifty_moves_rule))
+                return error;
+            skip_spaces();
+            if ((id < size) && (fen[id] >= '0') && (fen[id] <= '9'))
+            {
+                if (const FenError error = parse_number(fields.total_moves))
+                    return error;
+                skip_spaces();
+            }
+        }
+        fields.operations = fen.substr(id);
+        return {};
+    }
+
+    inline void load_fen(const FenFields &fields, Board &brd)
+    {
+        brd.clear_board();
+        for (int i = 0; i < 64; ++i)
+        {
+            if (fields.pieces[i] != No_Piece)
+                brd.set_piece(i, fields.pieces[i]);
+        }
+        brd.set_turn(fields.turn);
+        brd.set_castling(fields.castling);
+        brd.set_en_passant(fields.en_passant);
+        brd.set_fifty_rule(fields.fifty_moves_rule);
+        brd.set_total_moves(fields.total_moves);
+        brd.find_kings();
+    }
+
+    /// the board is left untouched when the FEN is rejected
+    inline FenError parse_fen(const std::string_view fen, Board &brd)
+    {
+        FenFields fields;
+        const FenError error = parse_fen(fen, fields);
+        if (!error)
+            load_fen(fields, brd);
+        return error;
+    }
+
+    /// enough for any position and counters below 10^9
+    constexpr int fen_buffer_size = 128;
+
+    constexpr char fen_piece_chars[] = "PNBRQKpnbrqk";
+
+    /// piece_at(square) gives the piece on a square, returns the end of the written FEN (no terminator)
+    template <class PieceAt>
+    inline char *write_fen(char *out, const PieceAt &piece_at, const Color turn, const CastlingRights castling,
+                           const Square en_passant, const int fifty_moves_rule, const int total_moves)
+    {
+        for (int rank = 7; rank >= 0; --rank)
+        {
+            int empty = 0;
+            for (int file = 0; file < 8; ++file)
+            {
+                const Piece piece = piece_at(rank * 8 + file);
+                if (piece == No_Piece)
+                {
+                    ++empty;
+                    continue;
+                }
+                if (empty != 0)
+                    *out++ = '0' + empty;
+                empty = 0;
+                *out++ = fen_piece_chars[piece];
+            }
+            if (empty != 0)
+                *out++ = '0' + empty;
+            if (rank != 0)
+                *out++ = '/';
+        }
+
+        *out++ = ' ';
+        *out++ = turn ? 'w' : 'b';
+
+        *out++ = ' ';
+        if (castling == NO_Castling)
+            *out++ = '-';
+        if (contains(castling, White_OO))
+            *out++ = 'K';
+        if (contains(castling, White_OOO))
+            *out++ = 'Q';
+        if (contains(castling, Black_OO))
+            *out++ = 'k';
+        if (contains(castling, Black_OOO))
+            *out++ = 'q';
+
+        *out++ = ' ';
+        if (en_passant == No_Square)
+            *out++ = '-';
+        else
+        {
+            *out++ = 'a' + en_passant % 8;
+            *out++ = '1' + en_passant / 8;
+        }
+
+        *out++ = ' ';
+        out = std::to_chars(out, out + 10, fifty_moves_rule).ptr;
+        *out++ = ' ';
+        return std::to_chars(out, out + 10, total_moves).ptr;
+    }
+
+    /// out needs fen_buffer_size chars
+    inline char *write_fen(char *out, const Board &brd)
+    {
+        return write_fen(out, [&brd](const int id)
+                         { return brd[id]; }, brd.get_turn(), brd.get_castling(), brd.get_en_passant(),
+                         brd.get_fifty_rule(), brd.get_total_moves());
+    }
+}
@@ -0,0 +1,477 @@
+#pragma once
+#include "uci.hpp"
+#include "tablebase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace chess
+{
+    /// Sequential probability ratio test of H1: elo = elo1 against H0: elo = elo0, on the logistic elo scale,
+    /// with the usual normal approximation of the log-likelihood ratio over win/draw/loss counts
+    struct Sprt
+    {
+        double elo0 = 0.0, elo1 = 5.0, alpha = 0.05, beta = 0.05;
+
+        static double elo_to_score(const double elo) { return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0)); }
+
+        double lower_bound() const { return std::log(beta / (1.0 - alpha)); }
+        double upper_bound() const { return std::log((1.0 - beta) / alpha); }
+
+        /// half a game is added to every count, so a one-sided run still has a variance and stops
+        double llr(const int64_t wins, const int64_t draws, const int64_t losses) const
+        {
+            if (wins + draws + losses == 0)
+                return 0.0;
+            const double w = wins + 0.5, d = draws + 0.5, l = losses + 0.5;
+            const double games = w + d + l;
+            const double score = (w + d / 2.0) / games;
+            const double variance = (w * (1.0 - score) * (1.0 - score) + d * (0.5 - score) * (0.5 - score) + l * score * score) / games;
+            const double score0 = elo_to_score(elo0), score1 = elo_to_score(elo1);
+            return games * (score1 - score0) * (2.0 * score - score0 - score1) / (2.0 * variance);
+        }
+
+        /// 1 accepts H1, -1 accepts H0, 0 needs more games
+        int decision(const int64_t wins, const int64_t draws, const int64_t losses) const
+        {
+            const double value = llr(wins, draws, losses);
+            return (value >= upper_bound()) ? 1 : (value <= lower_bound()) ? -1 : 0;
+        }
+    };
+
+    /// elo difference from a score and its 95% margin
+    inline std::pair<double, double> elo_estimate(const int64_t wins, const int64_t draws, const int64_t losses)
+    {
+        const double games = static_cast<double>(wins + draws + losses);
+        if (games == 0)
+            return {0.0, 0.0};
+        const double score = std::clamp((wins + draws / 2.0) / games, 1e-3, 1.0 - 1e-3);
+        const double variance = (wins * (1.0 - score) * (1.0 - score) + draws * (0.5 - score) * (0.5 - score) + losses * score * score) / games;
+        const double margin = 1.96 * std::sqrt(variance / games);
+        auto elo = [](const double s) { return -400.0 * std::log10(1.0 / std::clamp(s, 1e-3, 1.0 - 1e-3) - 1.0); };
+        return {elo(score), (elo(score + margin) - elo(score - margin)) / 2.0};
+    }
+
+    /// a move in UCI notation and the score the engine gave it for the side to move
+    struct EngineMove
+    {
+        std::string move;
+        int score = 0;
+    };
+
+    /// One side of a game, asked for a move with the opening FEN and the moves played since
+    class MatchEngine
+    {
+    public:
+        virtual ~MatchEngine() = default;
+        virtual void new_game() {}
+        virtual EngineMove go(const std::string &fen, const std::vector<std::string> &moves) = 0;
+    };
+
+    template <Color clr>
+    bool apply_uci_move(Board &brd, const std::string &str, Movelist_ref list_ref)
+    {
+        Movegen generator(brd, list_ref);
+        generator.gen_all_moves<clr>();
+        for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i)
+        {
+            if (move_to_uci(*i) == str)
+            {
+                brd.unstable_make_move<clr>(*i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline bool apply_uci_move(Board &brd, const std::string &str, Movelist_ref list_ref)
+    {
+        return brd.get_turn() ? apply_uci_move<White>(brd, str, list_ref) : apply_uci_move<Black>(brd, str, list_ref);
+    }
+
+    /// this engine in the same process, configured through its AI
+    class BuiltinEngine : public MatchEngine
+    {
+    private:
+        Board brd;
+        Movelist<5000> list;
+        Movelist_ref list_ref{list};
+        AI ai{brd, list_ref};
+        NnueNetwork network;
+        SearchLimits limits;
+
+    public:
+        explicit BuiltinEngine(const SearchLimits &search_limits) : limits(search_limits) {}
+
+        AI &get_ai() { return ai; }
+
+        /// false if the network can't be loaded
+        bool load_network(const char *path)
+        {
+            if (!network.load(path))
+                return false;
+            ai.set_network(&network);
+            return true;
+        }
+
+        EngineMove go(const std::string &fen, const std::vector<std::string> &moves) override
+        {
+            parse_fen(fen, brd);
+            for (const std::string &move : moves)
+                apply_uci_move(brd, move, Movelist_ref(list));
+            ai.clear_stop();
+            const auto [move, score] = ai.search(limits, [](const SearchInfo &) {});
+            return {move_to_uci(move), score};
+        }
+    };
+
+    /// another engine binary spoken to over UCI through pipes, the command is run by /bin/sh
+    class UciEngine : public MatchEngine
+    {
+    private:
+        pid_t pid = -1;
+        FILE *to_engine = nullptr;
+        FILE *from_engine = nullptr;
+        std::string go_command;
+
+        void send(const std::string &line)
+        {
+            fprintf(to_engine, "%s\n", line.c_str());
+            fflush(to_engine);
+        }
+
+        // the first line starting with token, empty if the engine went away
+        std::string wait_for(const std::string &token, EngineMove *info = nullptr)
+        {
+            char buffer[4096];
+            while (fgets(buffer, sizeof(buffer), from_engine) != nullptr)
+            {
+                const std::string line(buffer, strcspn(buffer, "\r\n"));
+                if (line.compare(0, token.size(), token) == 0)
+                    return line;
+                if ((info != nullptr) && (line.compare(0, 5, "info ") == 0))
+                {
+                    std::istringstream in(line);
+                    std::string word;
+                    while (in >> word)
+                    {
+                        if (word != "score")
+                            continue;
+                        std::string kind;
+                        int value;
+                        if (in >> kind >> value)
+                            info->score = (kind == "mate") ? ((value > 0) ? mate_score - (2 * value - 1) : -mate_score - 2 * value) : value;
+                    }
+                }
+            }
+            return "";
+        }
+
+    public:
+        /// options are sent as "setoption name <first> value <second>"
+        UciEngine(const std::string &command, const std::vector<std::pair<std::string, std::string>> &options, const SearchLimits &limits)
+        {
+            go_command = "go";
+            if (limits.movetime != 0)
+                go_command += " movetime " + std::to_string(limits.movetime);
+            else if (limits.nodes != 0)
+                go_command += " nodes " + std::to_string(limits.nodes);
+            else
+                go_command += " depth " + std::to_string(limits.depth);
+
+            int input[2], output[2];
+            if ((pipe(input) != 0) || (pipe(output) != 0))
+                return;
+            pid = fork();
+            if (pid == 0)
+            {
+                dup2(input[0], STDIN_FILENO);
+                dup2(output[1], STDOUT_FILENO);
+                close(input[0]);
+                close(input[1]);
+                close(output[0]);
+                close(output[1]);
+                execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char *>(nullptr));
+                _exit(127);
+            }
+            close(input[0]);
+            close(output[1]);
+            to_engine = fdopen(input[1], "w");
+            from_engine = fdopen(output[0], "r");
+            // a dead engine must not kill the match on the next write
+            signal(SIGPIPE, SIG_IGN);
+
+            send("uci");
+            wait_for("uciok");
+            for (const auto &[name, value] : options)
+                send("setoption name " + name + " value " + value);
+            send("isready");
+            wait_for("readyok");
+        }
+
+        ~UciEngine() override
+        {
+            if (to_engine != nullptr)
+            {
+                send("quit");
+                fclose(to_engine);
+            }
+            if (from_engine != nullptr)
+                fclose(from_engine);
+            if (pid > 0)
+                waitpid(pid, nullptr, 0);
+        }
+
+        bool is_running() const { return (pid > 0) && (to_engine != nullptr); }
+
+        void new_game() override
+        {
+            send("ucinewgame");
+            send("isready");
+            wait_for("readyok");
+        }
+
+        EngineMove go(const std::string &fen, const std::vector<std::string> &moves) override
+        {
+            std::string position = "position fen " + fen;
+            if (!moves.empty())
+            {
+                position += " moves";
+                for (const std::string &move : moves)
+                    position += " " + move;
+            }
+            send(position);
+            send(go_command);
+            EngineMove result;
+            const std::string line = wait_for("bestmove", &result);
+            std::istringstream in(line);
+            std::string word;
+            in >> word >> result.move;
+            return result;
+        }
+    };
+
+    enum GameResult : int
+    {
+        White_wins = 1,
+        Game_drawn = 0,
+        Black_wins = -1
+    };
+
+    /// 0 turns an adjudication off
+    struct Adjudication
+    {
+        // both sides agree one of them is ahead by resign_score for resign_plies plies each
+        int resign_score = 1000;
+        int resign_plies = 4;
+        // both sides score within draw_score for draw_plies plies each, from draw_move on
+        int draw_score = 10;
+        int draw_plies = 8;
+        int draw_move = 40;
+        // the game ends at this many plies as a draw
+        int max_plies = 400;
+        const Tablebases *tablebases = nullptr;
+    };
+
+    inline bool insufficient_material(const Board &brd)
+    {
+        int minors = 0;
+        for (int i = 0; i < 64; ++i)
+        {
+            const int type = brd[i] % 6;
+            if ((brd[i] == No_Piece) || (type == W_King))
+                continue;
+            if ((type != W_Knight) && (type != W_Bishop))
+                return false;
+            ++minors;
+        }
+        return minors <= 1;
+    }
+
+    /// plays one game from fen, white and black move alternately; illegal or missing moves lose
+    inline GameResult play_game(const std::string &fen, MatchEngine &white, MatchEngine &black, const Adjudication &adjudication, std::string *reason = nullptr)
+    {
+        auto finish = [&](const GameResult result, const char *why)
+        {
+            if (reason != nullptr)
+                *reason = why;
+            return result;
+        };
+        Board brd;
+        if (parse_fen(fen, brd))
+            return finish(Game_drawn, "bad opening");
+        Movelist<512> list;
+        std::vector<std::string> moves;
+        std::vector<u64> history{brd.get_hash()};
+        int fifty = brd.get_fifty_rule(), resign_count[2] = {0, 0}, last_score[2] = {0, 0}, draw_count = 0;
+        white.new_game();
+        black.new_game();
+        int tb_pieces = 0;
+        for (int i = 0; i < 64; ++i)
+            tb_pieces += brd[i] != No_Piece;
+
+        for (int ply = 0;; ++ply)
+        {
+            const Color turn = brd.get_turn();
+            Movelist_ref list_ref(list);
+            Movegen generator(brd, list_ref);
+            const PositionState state = turn ? generator.gen_all_moves<White>() : generator.gen_all_moves<Black>();
+            if (list_ref.no_moves())
+            {
+                if (state >= check)
+                    return finish(turn ? Black_wins : White_wins, "checkmate");
+                return finish(Game_drawn, "stalemate");
+            }
+            if (fifty >= 100)
+                return finish(Game_drawn, "fifty moves");
+            if (std::count(history.begin(), history.end(), history.back()) >= 3)
+                return finish(Game_drawn, "repetition");
+            if (insufficient_material(brd))
+                return finish(Game_drawn, "insufficient material");
+            if ((adjudication.max_plies != 0) && (ply >= adjudication.max_plies))
+                return finish(Game_drawn, "too long");
+            if ((adjudication.tablebases != nullptr) && (tb_pieces <= adjudication.tablebases->get_max_pieces()))
+            {
+                const TbProbe probe = adjudication.tablebases->probe(brd);
+                if (probe.found)
+                {
+                    const GameResult side_wins = turn ? White_wins : Black_wins;
+                    return finish((probe.wdl == TB_Win) ? side_wins : (probe.wdl == TB_Loss) ? GameResult(-side_wins) : Game_drawn, "tablebase");
+                }
+            }
+
+            const EngineMove reply = (turn ? white : black).go(fen, moves);
+            Move_full_info move;
+            for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i)
+            {
+                if (move_to_uci(*i) == reply.move)
+                    move = *i;
+            }
+            if (move.from_square == No_Square)
+                return finish(turn ? Black_wins : White_wins, "illegal move");
+
+            // the scores are from the mover's side, white's side from here on
+            const int score = turn ? reply.score : -reply.score;
+            if (adjudication.resign_score != 0)
+            {
+                resign_count[turn] = (std::abs(score) >= adjudication.resign_score) ? resign_count[turn] + 1 : 0;
+                last_score[turn] = score;
+                if ((resign_count[White] >= adjudication.resign_plies) && (resign_count[Black] >= adjudication.resign_plies) &&
+                    ((last_score[White] > 0) == (last_score[Black] > 0)))
+                    return finish((score > 0) ? White_wins : Black_wins, "resign");
+            }
+            if (adjudication.draw_score != 0)
+            {
+                draw_count = (std::abs(score) <= adjudication.draw_score) ? draw_count + 1 : 0;
+                if ((ply / 2 >= adjudication.draw_move) && (draw_count >= 2 * adjudication.draw_plies))
+                    return finish(Game_drawn, "draw adjudication");
+            }
+
+            const bool zeroing = (brd[move.to_square] != No_Piece) || (brd[move.from_square] % 6 == W_Pawn);
+            tb_pieces -= (brd[move.to_square] != No_Piece) || (move.special == SP_en_passant);
+            turn ? brd.unstable_make_move<White>(move) : brd.unstable_make_move<Black>(move);
+            moves.push_back(reply.move);
+            fifty = zeroing ? 0 : fifty + 1;
+            if (zeroing)
+                history.clear();
+            history.push_back(brd.get_hash());
+        }
+    }
+
+    /// running totals from the first engine's side
+    struct MatchScore
+    {
+        int64_t wins = 0, draws = 0, losses = 0;
+
+        int64_t games() const { return wins + draws + losses; }
+    };
+
+    /// Games in pairs over the openings, each opening once with either engine as white, on threads
+    /// that each own their two engines. Stops after games games or once the SPRT decides.
+    class Match
+    {
+    public:
+        using EngineFactory = std::function<std::unique_ptr<MatchEngine>(int engine)>;
+        using Report = std::function<void(const MatchScore &, int64_t game, GameResult result, const std::string &reason)>;
+
+    private:
+        std::vector<std::string> openings;
+        Adjudication adjudication;
+        std::optional<Sprt> sprt;
+        std::mutex score_mutex;
+        MatchScore score;
+        std::atomic<int64_t> next_game{0};
+        std::atomic<bool> decided{false};
+
+    public:
+        Match(std::vector<std::string> opening_fens, const Adjudication &adjudication_rules, const std::optional<Sprt> &test)
+            : openings(std::move(opening_fens)), adjudication(adjudication_rules), sprt(test)
+        {
+            if (openings.empty())
+                openings.push_back("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        }
+
+        /// make(0) and make(1) build the two engines of a thread
+        MatchScore run(const int64_t games, const int threads, const EngineFactory &make, const Report &report)
+        {
+            auto worker = [&]()
+            {
+                std::unique_ptr<MatchEngine> engines[2] = {make(0), make(1)};
+                for (int64_t game = next_game++; (game < games) && !decided; game = next_game++)
+                {
+                    const std::string &fen = openings[(game / 2) % openings.size()];
+                    const bool first_is_white = game % 2 == 0;
+                    std::string reason;
+                    const GameResult result = first_is_white ? play_game(fen, *engines[0], *engines[1], adjudication, &reason)
+                                                             : play_game(fen, *engines[1], *engines[0], adjudication, &reason);
+                    const int first_result = first_is_white ? result : -result;
+
+                    std::lock_guard<std::mutex> lock(score_mutex);
+                    score.wins += first_result > 0;
+                    score.draws += first_result == 0;
+                    score.losses += first_result < 0;
+                    report(score, game, result, reason);
+                    if (sprt && (sprt->decision(score.wins, score.draws, score.losses) != 0))
+                        decided = true;
+                }
+            };
+            std::vector<std::thread> pool;
+            for (int i = 1; i < threads; ++i)
+                pool.emplace_back(worker);
+            worker();
+            for (std::thread &thread : pool)
+                thread.join();
+            return score;
+        }
+    };
+
+    /// the FENs of an EPD file, shuffled by seed, the operations after them are dropped
+    inline std::vector<std::string> load_openings(const char *path, const u64 seed)
+    {
+        std::vector<std::string> fens;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            FenFields fields;
+            if (line.empty() || parse_fen(line, fields))
+                continue;
+            fens.push_back(line.substr(0, line.size() - fields.operations.size()));
+            while (!fens.back().empty() && (fens.back().back() == ' '))
+                fens.back().pop_back();
+        }
+        std::shuffle(fens.begin(), fens.end(), std::mt19937_64(seed));
+        return fens;
+    }
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "../Board/board.hpp"
 #include "../tables.hpp"
+#ifdef MAESTRO_HYBRID
+#include "../maestro_coreSource/fill.hpp"
+#endif
 
 namespace chess
 {
@@ -287,12 +290,22 @@ namespace chess
         template <Color clr>
         inline bool is_id_under_any_check(const int id)
         {
+            #ifdef MAESTRO_HYBRID
+            constexpr Color enemy = change_color(clr);
+            const u64 occupied = board.get_occupied();
+            const u64 queens = board.get_bitboard(Queen_with_color<enemy>());
+            return ((king_moves[id] & board.get_bitboard(King_with_color<enemy>())) |
+                    (colored_pawns_attack_mask<clr>(bit_at(id)) & board.get_bitboard(Pawn_with_color<enemy>())) |
+                    (knights_moves[id] & board.get_bitboard(Knight_with_color<enemy>())) |
+                    (maestro::get_bishop_attack_mask(occupied, id) & (board.get_bitboard(Bishop_with_color<enemy>()) | queens)) |
+                    (maestro::get_rook_attack_mask(occupied, id) & (board.get_bitboard(Rook_with_color<enemy>()) | queens))) != 0;
+            #else
             return is_id_under_king_check<clr>(id) ||
                    is_id_under_pawn_check<clr>(id) ||
                    is_id_under_diagonal_check<clr>(id) ||
                    is_id_under_horizontal_vertical_check<clr>(id) ||
                    is_id_under_knight_check<clr>(id);
-            /// TODO: is under king check, is under pawn check
+            #endif
         }
 
         inline u64 mask_in_dir(const int from_id, int to_id, const Direction direction){
@@ -358,6 +371,19 @@ namespace chess
 
         template<Color clr>
         inline u64 attacked_squares_mask(){
+            #ifdef MAESTRO_HYBRID
+            constexpr Color enemy = change_color(clr);
+            const u64 queens = board.get_bitboard(Queen_with_color<enemy>());
+            u64 mask = king_moves[board.get_right_king_position<enemy>()] |
+                       colored_pawns_attack_mask<enemy>(board.get_bitboard(Pawn_with_color<enemy>())) |
+                       maestro::get_sliders_attack_fill(board.get_bitboard(Rook_with_color<enemy>()) | queens,
+                                                        board.get_bitboard(Bishop_with_color<enemy>()) | queens,
+                                                        board.get_bitboard(No_Piece) | board.get_bitboard(King_with_color<clr>()));
+            for(u64 knights = board.get_bitboard(Knight_with_color<enemy>()); knights; knights &= knights - 1){
+                mask |= knights_moves[maestro::bitscan(knights)];
+            }
+            return mask;
+            #else
             u64 mask = 0; 
             board.remove_king<clr>();
             mask |= king_moves[board.get_right_king_position<change_color(clr)>()];
@@ -384,6 +410,7 @@ namespace chess
 
             board.restore_king<clr>();
             return mask;
+            #endif
         }
 
         template <Color clr>
@@ -391,14 +418,14 @@ namespace chess
         {
 
             const KingNode king = king_squares_moves[from];
-            board[from] = No_Piece;
+            board.set_piece(from, No_Piece);
 
             for (int to : king.moves)
             {
                 if ((to != No_Square) && not_same_color_or_empty<clr>(to) && (!is_id_under_any_check<clr>(to)))
                     list.add(Move_full_info(from, to, No_promotion, No_special));
             }
-            board[from] = King_with_color<clr>();
+            board.set_piece(from, King_with_color<clr>());
         }
 
         // усі можливі напрямки тури
@@ -1421,7 +1448,13 @@ namespace chess
         template <Color clr>
         inline bool can_long_castle()
         {
-            board[board.get_right_king_position<clr>()] = No_Piece;
+            #ifdef MAESTRO_HYBRID
+            // castling is generated only out of check, so the king never shadows an attack on its path
+            constexpr u64 path = bit_at(long_castling_king_to_square<clr>() - 1) | bit_at(long_castling_king_to_square<clr>()) | bit_at(long_castling_rook_to_square<clr>());
+            return board.can_castle_long<clr>() && !(board.get_occupied() & path) &&
+                   (!is_id_under_any_check<clr>(long_castling_king_to_square<clr>())) && (!is_id_under_any_check<clr>(long_castling_rook_to_square<clr>()));
+            #else
+            board.set_piece(board.get_right_king_position<clr>(), No_Piece);
             bool can_castle;
             if constexpr (clr)
             {
@@ -1434,14 +1467,20 @@ namespace chess
                               (!is_id_under_any_check<clr>(SQ_C8)) && (!is_id_under_any_check<clr>(SQ_D8));
             }
 
-            board[board.get_right_king_position<clr>()] = King_with_color<clr>();
+            board.set_piece(board.get_right_king_position<clr>(), King_with_color<clr>());
             return can_castle;
+            #endif
         }
 
         template <Color clr>
         inline bool can_short_castle()
         {
-            board[board.get_right_king_position<clr>()] = No_Piece;
+            #ifdef MAESTRO_HYBRID
+            constexpr u64 path = bit_at(short_castling_rook_to_square<clr>()) | bit_at(short_castling_king_to_square<clr>());
+            return board.can_castle_short<clr>() && !(board.get_occupied() & path) &&
+                   (!is_id_under_any_check<clr>(short_castling_rook_to_square<clr>())) && (!is_id_under_any_check<clr>(short_castling_king_to_square<clr>()));
+            #else
+            board.set_piece(board.get_right_king_position<clr>(), No_Piece);
             bool can_castle;
             if constexpr (clr)
             {
@@ -1456,8 +1495,9 @@ namespace chess
                 can_castle = board.can_castle_short<clr>() && is_empty(SQ_F8) && is_empty(SQ_G8) &&
                              (!is_id_under_any_check<clr>(SQ_F8)) && (!is_id_under_any_check<clr>(SQ_G8));
             }
-            board[board.get_right_king_position<clr>()] = King_with_color<clr>();
+            board.set_piece(board.get_right_king_position<clr>(), King_with_color<clr>());
             return can_castle;
+            #endif
         }
 
         template <Color clr>
@@ -1470,30 +1510,30 @@ namespace chess
 
             if ((pawn.Left != No_Square) && (board[pawn.Left] == Pawn_with_color<clr>()))
             {
-                board[pawn.Left] = No_Piece;
-                board[en_passant] = Pawn_with_color<clr>();
-                board[en_passant + pawn_en_passant_direction_to<clr>()] = No_Piece;
+                board.set_piece(pawn.Left, No_Piece);
+                board.set_piece(en_passant, Pawn_with_color<clr>());
+                board.set_piece(en_passant + pawn_en_passant_direction_to<clr>(), No_Piece);
                 if (!is_id_under_any_check<clr>(board.get_right_king_position<clr>()))
                 {
                     list.add(Move_full_info(pawn.Left, en_passant, No_promotion, SP_en_passant));
                 }
-                board[pawn.Left] = Pawn_with_color<clr>();
-                board[en_passant] = No_Piece;
-                board[en_passant + pawn_en_passant_direction_to<clr>()] = Pawn_with_color<change_color(clr)>();
+                board.set_piece(pawn.Left, Pawn_with_color<clr>());
+                board.set_piece(en_passant, No_Piece);
+                board.set_piece(en_passant + pawn_en_passant_direction_to<clr>(), Pawn_with_color<change_color(clr)>());
             }
 
             if ((pawn.Right != No_Square) && (board[pawn.Right] == Pawn_with_color<clr>()))
             {
-                board[pawn.Right] = No_Piece;
-                board[en_passant] = Pawn_with_color<clr>();
-                board[en_passant + pawn_en_passant_direction_to<clr>()] = No_Piece;
+                board.set_piece(pawn.Right, No_Piece);
+                board.set_piece(en_passant, Pawn_with_color<clr>());
+                board.set_piece(en_passant + pawn_en_passant_direction_to<clr>(), No_Piece);
                 if (!is_id_under_any_check<clr>(board.get_right_king_position<clr>()))
                 {
                     list.add(Move_full_info(pawn.Right, en_passant, No_promotion, SP_en_passant));
                 }
-                board[pawn.Right] = Pawn_with_color<clr>();
-                board[en_passant] = No_Piece;
-                board[en_passant + pawn_en_passant_direction_to<clr>()] = Pawn_with_color<change_color(clr)>();
+                board.set_piece(pawn.Right, Pawn_with_color<clr>());
+                board.set_piece(en_passant, No_Piece);
+                board.set_piece(en_passant + pawn_en_passant_direction_to<clr>(), Pawn_with_color<change_color(clr)>());
             }
         }
 
@@ -1565,6 +1605,7 @@ namespace chess
 
         template<Color color>
         PositionState gen_all_moves(){
+            MAESTRO_PROFILE_SCOPE(Prof_gen_moves);
             list.clear_moves();
             PositionState state;
             int attack_sq;
@@ -1588,6 +1629,7 @@ namespace chess
 
         template<Color color>
         PositionState gen_all_moves(const Move_full_info move){
+            MAESTRO_PROFILE_SCOPE(Prof_gen_moves);
             PositionState state;
             int attack_sq;
             Direction attack_dir;
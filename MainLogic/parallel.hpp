@@ -0,0 +1,137 @@
+#pragma once
+#include "../ai.hpp"
+#include "transposition.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace chess{
+
+    /// ABDADA over AI::search: every thread runs the same iterative deepening on its own board, sharing one
+    /// transposition table through which they see the nodes the others are in and take siblings first.
+    /// The caller's AI is the main thread and gives the result; the helpers stop when it returns.
+    class ParallelSearch{
+    private:
+        struct Helper{
+            Board brd;
+            Movelist<5000> list;
+            Movelist_ref list_ref{list};
+            AI ai{brd, list_ref};
+            std::thread thread;
+            #ifdef MAESTRO_PROFILE
+            // the counters of the thread's last search
+            Profile profile;
+            #endif
+        };
+
+        TranspositionTable tt;
+        // the AI is big (network accumulators), helpers live on the heap
+        std::vector<std::unique_ptr<Helper>> helpers;
+        const NnueNetwork *network = nullptr;
+        const Tablebases *tablebases = nullptr;
+        size_t eval_cache_mb = 4;
+
+        void configure(AI &ai){
+            ai.set_transposition_table(&tt);
+            ai.set_network(network);
+            ai.set_tablebases(tablebases);
+            ai.set_eval_cache_size(eval_cache_mb);
+        }
+
+    public:
+        explicit ParallelSearch(const size_t hash_mb = 16):tt(hash_mb){}
+
+        /// threads counts the caller's, not during a search
+        void set_threads(const int threads){
+            helpers.resize(std::max(0, threads - 1));
+            for(auto &helper : helpers){
+                if(!helper){
+                    helper = std::make_unique<Helper>();
+                    configure(helper->ai);
+                }
+            }
+        }
+
+        inline int get_threads()const{
+            return static_cast<int>(helpers.size()) + 1;
+        }
+
+        void set_hash_size(const size_t megabytes){
+            tt.resize(megabytes);
+        }
+
+        /// before a new game
+        void clear(){
+            tt.clear();
+        }
+
+        /// the helpers follow the main AI's evaluation and tables, set both through here
+        void set_network(const NnueNetwork *nnue){
+            network = nnue;
+            for(auto &helper : helpers)
+                helper->ai.set_network(network);
+        }
+
+        void set_tablebases(const Tablebases *tbs){
+            tablebases = tbs;
+            for(auto &helper : helpers)
+                helper->ai.set_tablebases(tablebases);
+        }
+
+        void set_eval_cache_size(const size_t megabytes){
+            eval_cache_mb = megabytes;
+            for(auto &helper : helpers)
+                helper->ai.set_eval_cache_size(megabytes);
+        }
+
+        inline TranspositionTable& get_transposition_table(){
+            return tt;
+        }
+
+        /// main searches the position of its board on the calling thread, stop it with main.request_stop()
+        std::tuple<Move_full_info, int> search(AI &main, const Board &position, const SearchLimits &limits,
+                                               const std::function<void(const SearchInfo&)> &report){
+            main.set_transposition_table(&tt);
+            // the helpers only stop with the main thread
+            SearchLimits helper_limits;
+            helper_limits.depth = limits.depth;
+            for(auto &helper : helpers){
+                helper->ai.set_position(position);
+                helper->ai.clear_stop();
+                helper->thread = std::thread([&helper, helper_limits](){
+                    #ifdef MAESTRO_PROFILE
+                    profile_thread.clear();
+                    #endif
+                    helper->ai.search(helper_limits, [](const SearchInfo&){});
+                    #ifdef MAESTRO_PROFILE
+                    helper->profile = profile_thread;
+                    #endif
+                });
+            }
+            const auto result = main.search(limits, report);
+            for(auto &helper : helpers)
+                helper->ai.request_stop();
+            for(auto &helper : helpers)
+                helper->thread.join();
+            return result;
+        }
+
+        /// the nodes of the helpers in the last search, the main AI counts its own
+        int64_t helper_nodes()const{
+            int64_t nodes = 0;
+            for(const auto &helper : helpers)
+                nodes += helper->ai.all_nodes;
+            return nodes;
+        }
+
+        #ifdef MAESTRO_PROFILE
+        /// the counters of the helpers in the last search, the main thread keeps its own in profile_thread
+        Profile helper_profile()const{
+            Profile profile;
+            for(const auto &helper : helpers)
+                profile += helper->profile;
+            return profile;
+        }
+        #endif
+    };
+}
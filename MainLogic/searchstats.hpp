@@ -0,0 +1,147 @@
+#pragma once
+#include "../types.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace chess{
+
+    /// Counters of one search, kept by the AI and reset at its root. -DMAESTRO_NO_STATS empties every
+    /// count_ function so the search pays nothing for them; the getters then report zeros.
+    class SearchStats{
+    public:
+        // moves tried before a beta cutoff, the last bucket takes everything later
+        static constexpr int cutoff_buckets = 16;
+        static constexpr int max_iterations = 64;
+
+        struct Iteration{
+            int depth;
+            // nodes and qnodes of this iteration alone
+            int64_t nodes;
+            int64_t time_us;
+        };
+
+    private:
+        int64_t nodes = 0;
+        int64_t qnodes = 0;
+        int64_t tt_probes = 0;
+        int64_t tt_hits = 0;
+        int64_t tt_cutoffs = 0;
+        std::array<int64_t, cutoff_buckets> cutoffs{};
+        std::array<Iteration, max_iterations> iterations{};
+        int iteration_count = 0;
+        int64_t iteration_start_nodes = 0;
+        int64_t time_us = 0;
+
+    public:
+        #ifdef MAESTRO_NO_STATS
+        static constexpr bool enabled = false;
+        #else
+        static constexpr bool enabled = true;
+        #endif
+
+        void reset(){
+            *this = SearchStats();
+        }
+
+        inline void count_node(){
+            if constexpr(enabled)
+                ++nodes;
+        }
+
+        inline void count_qnode(){
+            if constexpr(enabled)
+                ++qnodes;
+        }
+
+        inline void count_tt_probe(const bool hit){
+            if constexpr(enabled){
+                ++tt_probes;
+                tt_hits += hit;
+            }
+        }
+
+        inline void count_tt_cutoff(){
+            if constexpr(enabled)
+                ++tt_cutoffs;
+        }
+
+        /// index counts from 0 for the first move searched
+        inline void count_cutoff(const int64_t index){
+            if constexpr(enabled)
+                ++cutoffs[std::min<int64_t>(index, cutoff_buckets - 1)];
+        }
+
+        /// elapsed is from the start of the search
+        void finish_iteration(const int depth, const int64_t elapsed_us){
+            if constexpr(enabled){
+                const int64_t total = nodes + qnodes;
+                if(iteration_count < max_iterations)
+                    iterations[iteration_count++] = {depth, total - iteration_start_nodes, elapsed_us - time_us};
+                iteration_start_nodes = total;
+                time_us = elapsed_us;
+            }
+        }
+
+        inline int64_t get_nodes()const{ return nodes; }
+        inline int64_t get_qnodes()const{ return qnodes; }
+        inline int64_t get_tt_probes()const{ return tt_probes; }
+        inline int64_t get_tt_hits()const{ return tt_hits; }
+        inline int64_t get_tt_cutoffs()const{ return tt_cutoffs; }
+        inline const std::array<int64_t, cutoff_buckets>& get_cutoffs()const{ return cutoffs; }
+        inline int get_iteration_count()const{ return iteration_count; }
+        inline const Iteration& get_iteration(const int i)const{ return iterations[i]; }
+        inline int64_t get_time_us()const{ return time_us; }
+
+        inline int64_t nps()const{
+            return time_us ? (nodes + qnodes) * 1'000'000 / time_us : 0;
+        }
+
+        /// share of the cutoffs made by the first move, how good the move ordering is
+        inline double first_move_cutoff_rate()const{
+            int64_t all = 0;
+            for(const int64_t count : cutoffs)
+                all += count;
+            return all ? double(cutoffs[0]) / all : 0.0;
+        }
+
+        /// effective branching factor, the nodes of the last iteration over those of the one before
+        inline double ebf()const{
+            if(iteration_count < 2 || iterations[iteration_count - 2].nodes == 0)
+                return 0.0;
+            return double(iterations[iteration_count - 1].nodes) / iterations[iteration_count - 2].nodes;
+        }
+
+        /// one line without the "info string " prefix
+        std::string uci_info()const{
+            char line[512];
+            int length = std::snprintf(line, sizeof(line), "stats nodes %lld qnodes %lld tt %lld/%lld cutoffs %lld nps %lld ebf %.2f first %.3f cutoff index",
+                                       static_cast<long long>(nodes), static_cast<long long>(qnodes), static_cast<long long>(tt_hits),
+                                       static_cast<long long>(tt_probes), static_cast<long long>(tt_cutoffs), static_cast<long long>(nps()),
+                                       ebf(), first_move_cutoff_rate());
+            for(const int64_t count : cutoffs)
+                length += std::snprintf(line + length, sizeof(line) - length, " %lld", static_cast<long long>(count));
+            return std::string(line, std::min<size_t>(length, sizeof(line) - 1));
+        }
+
+        std::string json()const{
+            std::string out = "{\"nodes\":" + std::to_string(nodes) + ",\"qnodes\":" + std::to_string(qnodes) +
+                              ",\"tt_probes\":" + std::to_string(tt_probes) + ",\"tt_hits\":" + std::to_string(tt_hits) +
+                              ",\"tt_cutoffs\":" + std::to_string(tt_cutoffs) + ",\"time_us\":" + std::to_string(time_us) +
+                              ",\"nps\":" + std::to_string(nps());
+            char ebf_text[32];
+            std::snprintf(ebf_text, sizeof(ebf_text), "%.4f", ebf());
+            out += ",\"ebf\":" + std::string(ebf_text) + ",\"cutoff_index\":[";
+            for(int i = 0; i < cutoff_buckets; ++i)
+                out += (i ? "," : "") + std::to_string(cutoffs[i]);
+            out += "],\"iterations\":[";
+            for(int i = 0; i < iteration_count; ++i){
+                out += (i ? ",{" : "{") + std::string("\"depth\":") + std::to_string(iterations[i].depth) +
+                       ",\"nodes\":" + std::to_string(iterations[i].nodes) + ",\"time_us\":" + std::to_string(iterations[i].time_us) + "}";
+            }
+            return out + "]}";
+        }
+    };
+}
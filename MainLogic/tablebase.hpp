@@ -0,0 +1,351 @@
+#pragma once
+#include "movegen.hpp"
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chess
+{
+    /// Endgame tables: win/draw/loss and distance to zeroing (capture, pawn move or mate)
+    /// for every placement of a material set, without castling rights.
+    /// Values are from the side to move, like Syzygy without the 50 move rule.
+
+    enum TbWDL : int
+    {
+        TB_Loss = -2,
+        TB_Draw = 0,
+        TB_Win = 2
+    };
+
+    // entries of impossible placements (two pieces on a square, pawn on the last rank, side not to move in check)
+    constexpr i8 TB_invalid = -128;
+
+    constexpr int tb_max_pieces = 4;
+
+    struct TbProbe
+    {
+        bool found = false;
+        int wdl = TB_Draw;
+        int dtz = 0;
+    };
+
+    /// 4 bits of count per piece kind
+    using MaterialKey = u64;
+
+    inline MaterialKey material_key(const Board &brd)
+    {
+        MaterialKey key = 0;
+        for (int i = 0; i < 64; ++i)
+        {
+            if (brd[i] != No_Piece)
+                key += MaterialKey(1) << (brd[i] * 4);
+        }
+        return key;
+    }
+
+    constexpr int material_count(const MaterialKey key, const Piece piece)
+    {
+        return (key >> (piece * 4)) & 0xf;
+    }
+
+    constexpr int material_pieces(MaterialKey key)
+    {
+        int count = 0;
+        for (; key != 0; key >>= 4)
+            count += key & 0xf;
+        return count;
+    }
+
+    /// white and black exchanged
+    constexpr MaterialKey swap_material(const MaterialKey key)
+    {
+        return ((key & 0xffffffull) << 24) | ((key >> 24) & 0xffffffull);
+    }
+
+    // queens first, so "KQvKR" and not "KRvKQ" is the stored table
+    constexpr bool is_canonical(const MaterialKey key)
+    {
+        constexpr int values[] = {1, 3, 3, 5, 9, 0};
+        int white = 0, black = 0;
+        for (int piece = 0; piece < 6; ++piece)
+        {
+            white += material_count(key, static_cast<Piece>(piece)) * values[piece];
+            black += material_count(key, static_cast<Piece>(piece + 6)) * values[piece];
+        }
+        if (white != black)
+            return white > black;
+        for (int piece = W_Queen; piece >= W_Pawn; --piece)
+        {
+            if (material_count(key, static_cast<Piece>(piece)) != material_count(key, static_cast<Piece>(piece + 6)))
+                return material_count(key, static_cast<Piece>(piece)) > material_count(key, static_cast<Piece>(piece + 6));
+        }
+        return true;
+    }
+
+    constexpr Piece tb_piece_order[] = {W_King, W_Queen, W_Rook, W_Bishop, W_Knight, W_Pawn,
+                                        B_King, B_Queen, B_Rook, B_Bishop, B_Knight, B_Pawn};
+
+    /// the pieces in table order, white king first then Q R B N P, then black the same way
+    inline int material_to_pieces(const MaterialKey key, Piece *pieces)
+    {
+        int count = 0;
+        for (const Piece piece : tb_piece_order)
+        {
+            for (int i = 0; i < material_count(key, piece); ++i)
+                pieces[count++] = piece;
+        }
+        return count;
+    }
+
+    /// "KQvK"
+    inline types::string material_name(const MaterialKey key)
+    {
+        types::string name;
+        for (const Piece piece : tb_piece_order)
+        {
+            if (piece == B_King)
+                name += 'v';
+            name.append(material_count(key, piece), "PNBRQK"[piece % 6]);
+        }
+        return name;
+    }
+
+    /// 0 when the name is not a material set with one king per side
+    inline MaterialKey material_from_name(const std::string_view name)
+    {
+        MaterialKey key = 0;
+        int side = 0;
+        for (const char symb : name)
+        {
+            if (symb == 'v')
+            {
+                if (++side > 1)
+                    return 0;
+                continue;
+            }
+            const char *kind = std::strchr("PNBRQK", symb);
+            if ((kind == nullptr) || (symb == '\0'))
+                return 0;
+            key += MaterialKey(1) << (((kind - "PNBRQK") + side * 6) * 4);
+        }
+        if ((side != 1) || (material_count(key, W_King) != 1) || (material_count(key, B_King) != 1))
+            return 0;
+        return key;
+    }
+
+    constexpr size_t tb_entries(const int pieces)
+    {
+        return size_t(2) << (6 * pieces);
+    }
+
+    /// white to move first, then the squares in table order, first piece in the highest bits
+    constexpr size_t tb_index(const Square *squares, const int count, const Color turn)
+    {
+        size_t index = turn ? 0 : 1;
+        for (int i = 0; i < count; ++i)
+            index = (index << 6) | squares[i];
+        return index;
+    }
+
+    constexpr Color tb_decode_index(size_t index, Square *squares, const int count)
+    {
+        for (int i = count - 1; i >= 0; --i)
+        {
+            squares[i] = static_cast<Square>(index & 63);
+            index >>= 6;
+        }
+        return index ? Black : White;
+    }
+
+    /// on disk: the header, entries() signed WDL bytes, then entries() DTZ bytes
+    struct TbHeader
+    {
+        char magic[4];
+        u8 piece_count;
+        u8 reserved[3];
+        u64 material;
+        u64 entries;
+    };
+
+    static_assert(sizeof(TbHeader) == 24);
+
+    constexpr char tb_magic[4] = {'M', 'T', 'B', '1'};
+
+    class TbTable
+    {
+    private:
+        // generated tables own their bytes, loaded ones are mapped
+        std::vector<u8> image;
+        void *mapped = nullptr;
+        size_t mapped_size = 0;
+
+        const TbHeader *header = nullptr;
+        Piece pieces[8];
+
+    public:
+        TbTable() {}
+        TbTable(const TbTable &) = delete;
+        TbTable &operator=(const TbTable &) = delete;
+
+        ~TbTable()
+        {
+            if (mapped != nullptr)
+                munmap(mapped, mapped_size);
+        }
+
+        /// a table in memory, the image is a whole file
+        bool assign(std::vector<u8> &&bytes)
+        {
+            image = std::move(bytes);
+            return attach(image.data(), image.size());
+        }
+
+        bool load(const char *path)
+        {
+            const int fd = open(path, O_RDONLY);
+            if (fd < 0)
+                return false;
+            struct stat info;
+            bool loaded = false;
+            if ((fstat(fd, &info) == 0) && (info.st_size >= static_cast<off_t>(sizeof(TbHeader))))
+            {
+                void *ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (ptr != MAP_FAILED)
+                {
+                    mapped = ptr;
+                    mapped_size = info.st_size;
+                    loaded = attach(static_cast<const u8 *>(ptr), mapped_size);
+                }
+            }
+            close(fd);
+            return loaded;
+        }
+
+        bool attach(const u8 *bytes, const size_t size)
+        {
+            header = reinterpret_cast<const TbHeader *>(bytes);
+            if ((std::memcmp(header->magic, tb_magic, 4) != 0) || (header->piece_count > tb_max_pieces) ||
+                (header->piece_count != material_pieces(header->material)) || (header->entries != tb_entries(header->piece_count)) ||
+                (size < sizeof(TbHeader) + 2 * header->entries) || (material_to_pieces(header->material, pieces) != header->piece_count))
+            {
+                header = nullptr;
+                return false;
+            }
+            return true;
+        }
+
+        inline bool is_open() const { return header != nullptr; }
+        inline MaterialKey get_material() const { return header->material; }
+        inline int get_piece_count() const { return header->piece_count; }
+        inline const Piece *get_pieces() const { return pieces; }
+
+        inline const i8 *wdl() const { return reinterpret_cast<const i8 *>(header + 1); }
+        inline const u8 *dtz() const { return reinterpret_cast<const u8 *>(header + 1) + header->entries; }
+
+        bool save(const char *path) const
+        {
+            FILE *file = fopen(path, "wb");
+            if (file == nullptr)
+                return false;
+            const size_t size = sizeof(TbHeader) + 2 * header->entries;
+            const bool written = fwrite(header, 1, size, file) == size;
+            return (fclose(file) == 0) && written;
+        }
+
+        /// squares of the board in table order, colors exchanged and the board flipped when swapped
+        size_t index_of(const Board &brd, const bool swapped) const
+        {
+            Square squares[8];
+            bool used[8] = {};
+            const int count = header->piece_count;
+            for (int i = 0; i < 64; ++i)
+            {
+                if (brd[i] == No_Piece)
+                    continue;
+                const Piece piece = swapped ? static_cast<Piece>((brd[i] + 6) % 12) : brd[i];
+                for (int slot = 0; slot < count; ++slot)
+                {
+                    if (!used[slot] && (pieces[slot] == piece))
+                    {
+                        used[slot] = true;
+                        squares[slot] = static_cast<Square>(swapped ? (i ^ 56) : i);
+                        break;
+                    }
+                }
+            }
+            return tb_index(squares, count, static_cast<Color>(swapped != static_cast<bool>(brd.get_turn())));
+        }
+    };
+
+    /// the set of tables the engine knows, generated in memory or loaded from files
+    class Tablebases
+    {
+    private:
+        std::map<MaterialKey, std::unique_ptr<TbTable>> tables;
+        int max_pieces = 0;
+
+    public:
+        bool add(std::unique_ptr<TbTable> table)
+        {
+            if (!table->is_open())
+                return false;
+            max_pieces = std::max(max_pieces, table->get_piece_count());
+            tables[table->get_material()] = std::move(table);
+            return true;
+        }
+
+        /// one ".mtb" file
+        bool load(const char *path)
+        {
+            auto table = std::make_unique<TbTable>();
+            return table->load(path) && add(std::move(table));
+        }
+
+        /// every ".mtb" file in the directory, returns how many were loaded
+        int load_directory(const char *directory)
+        {
+            int loaded = 0;
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+            {
+                if (entry.path().extension() == ".mtb")
+                    loaded += load(entry.path().c_str());
+            }
+            return loaded;
+        }
+
+        inline int get_max_pieces() const { return max_pieces; }
+        inline size_t size() const { return tables.size(); }
+
+        const TbTable *find(const MaterialKey key) const
+        {
+            const auto table = tables.find(key);
+            return (table == tables.end()) ? nullptr : table->second.get();
+        }
+
+        /// positions with castling rights or an en passant square are not in the tables
+        TbProbe probe(const Board &brd) const
+        {
+            if ((brd.get_castling() != NO_Castling) || (brd.get_en_passant() != No_Square))
+                return {};
+            const MaterialKey key = material_key(brd);
+            if (material_pieces(key) > max_pieces)
+                return {};
+            const bool swapped = !is_canonical(key);
+            const TbTable *table = find(swapped ? swap_material(key) : key);
+            if (table == nullptr)
+                return {};
+            const size_t index = table->index_of(brd, swapped);
+            const i8 wdl = table->wdl()[index];
+            if (wdl == TB_invalid)
+                return {};
+            return {true, wdl, table->dtz()[index]};
+        }
+    };
+}
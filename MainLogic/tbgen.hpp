@@ -0,0 +1,316 @@
+#pragma once
+#include "tablebase.hpp"
+
+namespace chess
+{
+    /// Builds tables for up to tb_max_pieces pieces by iterating over every placement until nothing changes,
+    /// the tables a capture or promotion converts into are built first.
+    /// Slow for 4 pieces (minutes), meant for tests and for small sets.
+    class TbGenerator
+    {
+    private:
+        // only while generating, never stored
+        static constexpr i8 TB_unknown = 1;
+        static constexpr u8 dtz_unknown = 255;
+
+        Tablebases &tablebases;
+        Board brd;
+        Movelist<512> list;
+
+        int count = 0;
+        Piece pieces[8];
+        Square squares[8];
+        Color turn = White;
+        i8 *wdl = nullptr;
+        u8 *dtz = nullptr;
+
+        void clear_squares()
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                if (brd[squares[i]] == pieces[i])
+                    brd.set_piece(squares[i], No_Piece);
+            }
+        }
+
+        // false for an impossible placement, the board then holds whatever was put before the clash
+        bool setup(const size_t index)
+        {
+            turn = tb_decode_index(index, squares, count);
+            for (int i = 0; i < count; ++i)
+            {
+                const bool last_rank = (squares[i] < 8) || (squares[i] >= 56);
+                if ((brd[squares[i]] != No_Piece) || (last_rank && ((pieces[i] == W_Pawn) || (pieces[i] == B_Pawn))))
+                    return false;
+                brd.set_piece(squares[i], pieces[i]);
+            }
+            brd.set_turn(turn);
+            brd.find_kings();
+            Movelist_ref list_ref(list);
+            Movegen generator(brd, list_ref);
+            return turn ? !generator.is_id_under_any_check<Black>(king_square<Black>())
+                        : !generator.is_id_under_any_check<White>(king_square<White>());
+        }
+
+        template <Color clr>
+        Square king_square()
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                if (pieces[i] == King_with_color<clr>())
+                    return squares[i];
+            }
+            return No_Square;
+        }
+
+        template <Color clr>
+        bool is_zeroing(const Move_full_info move)
+        {
+            return (brd[move.to_square] != No_Piece) || (brd[move.from_square] == Pawn_with_color<clr>());
+        }
+
+        // the child stays in this table
+        template <Color clr>
+        size_t child_index(const Move_full_info move)
+        {
+            Square child[8];
+            for (int i = 0; i < count; ++i)
+                child[i] = (squares[i] == move.from_square) ? static_cast<Square>(move.to_square) : squares[i];
+            return tb_index(child, count, change_color(clr));
+        }
+
+        int probe_after(const Move_full_info move, const Color clr)
+        {
+            const Accumulator acc = clr ? brd.unstable_make_move<White>(move) : brd.unstable_make_move<Black>(move);
+            const TbProbe probe = tablebases.probe(brd);
+            clr ? brd.unstable_undo_move<White>(move, acc) : brd.unstable_undo_move<Black>(move, acc);
+            return probe.wdl;
+        }
+
+        // a double push next to an enemy pawn gives the child an en passant capture the table index does not see
+        template <Color clr>
+        int en_passant_wdl(const Move_full_info move, Movelist_ref list_ref)
+        {
+            int best = TB_Loss - 1;
+            const Accumulator acc = brd.unstable_make_move<clr>(move);
+            Movegen generator(brd, list_ref);
+            generator.gen_all_moves<change_color(clr)>();
+            for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i)
+            {
+                if (i->special == SP_en_passant)
+                    best = std::max(best, -probe_after(*i, change_color(clr)));
+            }
+            brd.unstable_undo_move<clr>(move, acc);
+            return best;
+        }
+
+        /// WDL of the position after the move for the side to move there, TB_unknown while unresolved
+        template <Color clr>
+        int child_wdl(const Move_full_info move, Movelist_ref list_ref)
+        {
+            if ((brd[move.to_square] != No_Piece) || (move.special == SP_Promotion))
+                return probe_after(move, clr);
+            const int table_wdl = wdl[child_index<clr>(move)];
+            const int to_file = move.to_square % 8;
+            if ((brd[move.from_square] != Pawn_with_color<clr>()) || ((move.to_square - move.from_square) != pawn_double_move_distance<clr>()) ||
+                !(((to_file != 0) && (brd[move.to_square - 1] == Pawn_with_color<change_color(clr)>())) ||
+                  ((to_file != 7) && (brd[move.to_square + 1] == Pawn_with_color<change_color(clr)>()))))
+                return table_wdl;
+            const int capture_wdl = en_passant_wdl<clr>(move, list_ref);
+            if (capture_wdl == TB_Win)
+                return TB_Win;
+            return (table_wdl == TB_unknown) ? TB_unknown : std::max(table_wdl, capture_wdl);
+        }
+
+        // resolved when a move wins or every move loses
+        template <Color clr>
+        bool resolve_wdl(const size_t index)
+        {
+            Movelist_ref list_ref(list);
+            Movegen generator(brd, list_ref);
+            generator.gen_all_moves<clr>();
+            bool all_win = true;
+            for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i)
+            {
+                const int value = child_wdl<clr>(*i, list_ref.get_ref());
+                if (value == TB_Loss)
+                {
+                    wdl[index] = TB_Win;
+                    return true;
+                }
+                all_win &= (value == TB_Win);
+            }
+            if (all_win)
+                wdl[index] = TB_Loss;
+            return all_win;
+        }
+
+        // the winner takes the shortest way to a zeroing move, the loser the longest
+        template <Color clr>
+        bool resolve_dtz(const size_t index, const int distance)
+        {
+            Movelist_ref list_ref(list);
+            Movegen generator(brd, list_ref);
+            generator.gen_all_moves<clr>();
+            const bool winning = wdl[index] == TB_Win;
+            int longest = 0;
+            for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i)
+            {
+                int value = 1;
+                if (!is_zeroing<clr>(*i))
+                {
+                    const size_t child = child_index<clr>(*i);
+                    if (winning && (wdl[child] != TB_Loss))
+                        continue;
+                    if (dtz[child] == dtz_unknown)
+                    {
+                        if (winning)
+                            continue;
+                        return false;
+                    }
+                    value = 1 + dtz[child];
+                }
+                else if (winning && (child_wdl<clr>(*i, list_ref.get_ref()) != TB_Loss))
+                    continue;
+                if (winning && (value <= distance))
+                {
+                    dtz[index] = value;
+                    return true;
+                }
+                longest = std::max(longest, value);
+            }
+            if (winning)
+                return false;
+            dtz[index] = std::min(longest, dtz_unknown - 1);
+            return true;
+        }
+
+        // runs resolve over the pending placements, the resolved ones are dropped.
+        // WDL is done once a pass changes nothing, DTZ can have quiet passes between two levels
+        template <class Resolve>
+        void iterate(std::vector<u32> &pending, const Resolve &resolve, const bool until_stable)
+        {
+            for (int pass = 1; !pending.empty() && (pass < dtz_unknown); ++pass)
+            {
+                size_t kept = 0;
+                for (const u32 index : pending)
+                {
+                    setup(index);
+                    const bool resolved = turn ? resolve.template operator()<White>(index, pass) : resolve.template operator()<Black>(index, pass);
+                    clear_squares();
+                    if (!resolved)
+                        pending[kept++] = index;
+                }
+                const bool changed = kept != pending.size();
+                pending.resize(kept);
+                if (until_stable && !changed)
+                    break;
+            }
+        }
+
+        std::unique_ptr<TbTable> build(const MaterialKey key)
+        {
+            count = material_to_pieces(key, pieces);
+            const size_t entries = tb_entries(count);
+            std::vector<u8> image(sizeof(TbHeader) + 2 * entries);
+            TbHeader header{};
+            std::memcpy(header.magic, tb_magic, 4);
+            header.piece_count = count;
+            header.material = key;
+            header.entries = entries;
+            std::memcpy(image.data(), &header, sizeof(header));
+            wdl = reinterpret_cast<i8 *>(image.data() + sizeof(TbHeader));
+            dtz = image.data() + sizeof(TbHeader) + entries;
+
+            // mates, stalemates and impossible placements are known from the start
+            std::vector<u32> pending;
+            for (size_t index = 0; index < entries; ++index)
+            {
+                dtz[index] = 0;
+                if (!setup(index))
+                {
+                    wdl[index] = TB_invalid;
+                    clear_squares();
+                    continue;
+                }
+                Movelist_ref list_ref(list);
+                Movegen generator(brd, list_ref);
+                const PositionState state = turn ? generator.gen_all_moves<White>() : generator.gen_all_moves<Black>();
+                clear_squares();
+                if (list_ref.no_moves())
+                    wdl[index] = (state >= check) ? TB_Loss : TB_Draw;
+                else
+                {
+                    wdl[index] = TB_unknown;
+                    dtz[index] = dtz_unknown;
+                    pending.push_back(index);
+                }
+            }
+
+            iterate(pending, [this]<Color clr>(const size_t index, int)
+                    { return resolve_wdl<clr>(index); }, true);
+            // nothing forces a result
+            for (const u32 index : pending)
+            {
+                wdl[index] = TB_Draw;
+                dtz[index] = 0;
+            }
+
+            pending.clear();
+            for (size_t index = 0; index < entries; ++index)
+            {
+                if (dtz[index] == dtz_unknown)
+                    pending.push_back(index);
+            }
+            iterate(pending, [this]<Color clr>(const size_t index, const int pass)
+                    { return resolve_dtz<clr>(index, pass); }, false);
+
+            auto table = std::make_unique<TbTable>();
+            table->assign(std::move(image));
+            return table;
+        }
+
+    public:
+        explicit TbGenerator(Tablebases &tbs) : tablebases(tbs)
+        {
+            brd.clear_board();
+            brd.set_castling(NO_Castling);
+            brd.set_en_passant(No_Square);
+        }
+
+        /// builds the table and all it converts into, false when the material is not supported
+        bool generate(MaterialKey key)
+        {
+            if (!is_canonical(key))
+                key = swap_material(key);
+            if (tablebases.find(key) != nullptr)
+                return true;
+            if ((material_pieces(key) > tb_max_pieces) || (material_count(key, W_King) != 1) || (material_count(key, B_King) != 1))
+                return false;
+
+            for (int piece = W_Pawn; piece <= B_King; ++piece)
+            {
+                if ((piece == W_King) || (piece == B_King) || (material_count(key, static_cast<Piece>(piece)) == 0))
+                    continue;
+                const MaterialKey captured = key - (MaterialKey(1) << (piece * 4));
+                if (!generate(captured))
+                    return false;
+                if ((piece == W_Pawn) || (piece == B_Pawn))
+                {
+                    for (int promotion = piece + 1; promotion < piece + 5; ++promotion)
+                    {
+                        if (!generate(captured + (MaterialKey(1) << (promotion * 4))))
+                            return false;
+                    }
+                }
+            }
+            return tablebases.add(build(key));
+        }
+
+        bool generate(const std::string_view name)
+        {
+            const MaterialKey key = material_from_name(name);
+            return (key != 0) && generate(key);
+        }
+    };
+}
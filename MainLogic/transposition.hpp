@@ -0,0 +1,104 @@
+#pragma once
+#include "../types.hpp"
+#include <atomic>
+#include <bit>
+#include <memory>
+
+namespace chess{
+
+    enum TTBound : u8{
+        TT_None,
+        TT_Upper,
+        TT_Lower,
+        TT_Exact
+    };
+
+    struct TTProbe{
+        bool found = false;
+        int score = 0;
+        int depth = 0;
+        TTBound bound = TT_None;
+        // Move_full_info::to_move(), 0 for none
+        Move move = 0;
+    };
+
+    /// Search results by position hash, shared by the threads of a parallel search.
+    /// Every entry is two words, the key is stored xored with the data so a torn write reads as a miss.
+    /// Next to every entry sits a count of the threads searching that position right now, the ABDADA
+    /// "being searched" mark that lets the other threads put the node off and take a sibling first.
+    class TranspositionTable{
+    private:
+        struct Entry{
+            std::atomic<u64> check{0};
+            std::atomic<u64> data{0};
+        };
+
+        std::unique_ptr<Entry[]> entries;
+        std::unique_ptr<std::atomic<u16>[]> searching;
+        size_t count = 0;
+        u64 mask = 0;
+
+        // score 32 bits, depth 8, bound 8, move 16
+        static inline u64 pack(const int score, const int depth, const TTBound bound, const Move move){
+            return static_cast<u32>(score) | (u64(static_cast<u8>(depth)) << 32) | (u64(bound) << 40) | (u64(move) << 48);
+        }
+
+    public:
+        explicit TranspositionTable(const size_t megabytes = 16){
+            resize(megabytes);
+        }
+
+        /// rounded down to a power of two entries, not while a search runs
+        void resize(const size_t megabytes){
+            count = std::bit_floor(std::max<size_t>(1, megabytes * 1024 * 1024 / (sizeof(Entry) + sizeof(u16))));
+            entries.reset(new Entry[count]);
+            searching.reset(new std::atomic<u16>[count]);
+            mask = count - 1;
+            clear();
+        }
+
+        void clear(){
+            for(size_t i = 0; i < count; ++i){
+                entries[i].check.store(0, std::memory_order_relaxed);
+                entries[i].data.store(0, std::memory_order_relaxed);
+                searching[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        inline TTProbe probe(const u64 key)const{
+            const Entry &entry = entries[key & mask];
+            const u64 data = entry.data.load(std::memory_order_relaxed);
+            const u64 check = entry.check.load(std::memory_order_relaxed);
+            if(((check ^ data) != key) || (data == 0))
+                return {};
+            return {true, static_cast<int32_t>(static_cast<u32>(data)), static_cast<int>((data >> 32) & 0xFF),
+                    static_cast<TTBound>((data >> 40) & 0xFF), static_cast<Move>(data >> 48)};
+        }
+
+        /// a different position always replaces, the same one only from at least as deep
+        inline void store(const u64 key, const int score, const int depth, const TTBound bound, const Move move){
+            Entry &entry = entries[key & mask];
+            const u64 old_data = entry.data.load(std::memory_order_relaxed);
+            if(((entry.check.load(std::memory_order_relaxed) ^ old_data) == key) && (static_cast<int>((old_data >> 32) & 0xFF) > depth))
+                return;
+            const u64 data = pack(score, depth, bound, move);
+            entry.data.store(data, std::memory_order_relaxed);
+            entry.check.store(key ^ data, std::memory_order_relaxed);
+        }
+
+        /// another thread is inside this node, collisions only make a thread put a node off for nothing
+        inline bool is_searching(const u64 key)const{
+            return searching[key & mask].load(std::memory_order_relaxed) != 0;
+        }
+
+        inline void start_search(const u64 key){
+            searching[key & mask].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        inline void finish_search(const u64 key){
+            searching[key & mask].fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        inline size_t size()const{ return count; }
+    };
+}
@@ -0,0 +1,316 @@
+#pragma once
+#include "fenView.hpp"
+#include "../Board/pawnhash.hpp"
+#include <immintrin.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chess{
+
+    // where the tuned values sit in the parameter vector, each one as a midlegame and an endgame value
+    constexpr int tune_material = 0;                    // by piece type, the king has none
+    constexpr int tune_squares = tune_material + 2 * 5; // by piece type and table square, a8 first
+    constexpr int tune_doubled = tune_squares + 2 * 6 * 64;
+    constexpr int tune_isolated = tune_doubled + 2;
+    constexpr int tune_passed = tune_isolated + 2;      // by rank from the pawn's own side
+    constexpr int tune_parameters = tune_passed + 2 * 8;
+
+    constexpr const char *tune_piece_names[6] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
+
+    /// the values Board/evaltables.hpp holds now
+    inline std::vector<double> default_tune_parameters(){
+        std::vector<double> params(tune_parameters);
+        for(int type = 0; type < 5; ++type){
+            params[tune_material + 2 * type] = material_midlegame[type];
+            params[tune_material + 2 * type + 1] = material_endgame[type];
+        }
+        for(int type = 0; type < 6; ++type){
+            for(int square = 0; square < 64; ++square){
+                params[tune_squares + 2 * (type * 64 + square)] = square_eval_midlegame[type][square];
+                params[tune_squares + 2 * (type * 64 + square) + 1] = square_eval_endgame[type][square];
+            }
+        }
+        params[tune_doubled] = doubled_pawn_midlegame;
+        params[tune_doubled + 1] = doubled_pawn_endgame;
+        params[tune_isolated] = isolated_pawn_midlegame;
+        params[tune_isolated + 1] = isolated_pawn_endgame;
+        for(int rank = 0; rank < 8; ++rank){
+            params[tune_passed + 2 * rank] = passed_pawn_midlegame[rank];
+            params[tune_passed + 2 * rank + 1] = passed_pawn_endgame[rank];
+        }
+        return params;
+    }
+
+    /// 1.0, 0.5 or 0.0 for White from "1-0", "1/2-1/2", "0-1" or a number like [0.5], -1 if there is none
+    inline double parse_game_result(const std::string_view text){
+        if(text.find("1/2-1/2") != std::string_view::npos)
+            return 0.5;
+        if(text.find("1-0") != std::string_view::npos)
+            return 1.0;
+        if(text.find("0-1") != std::string_view::npos)
+            return 0.0;
+        const size_t start = text.find_first_of("0123456789.");
+        if(start == std::string_view::npos)
+            return -1.0;
+        const std::string number(text.substr(start, text.find_first_not_of("0123456789.", start) - start));
+        char *end;
+        const double result = std::strtod(number.c_str(), &end);
+        return ((*end == '\0') && (result >= 0.0) && (result <= 1.0)) ? result : -1.0;
+    }
+
+    /// Texel tuning of the evaluation tables. The tables evaluate a position as a linear function of the
+    /// parameters, so every position is kept as its nonzero (parameter, weight) pairs with the phase blend
+    /// folded into the weights, and the evaluation of a position is a dot product over them.
+    class TexelTuner{
+    private:
+        // the pairs of position i are [offsets[i], offsets[i + 1]), padded to multiples of 8 with zero weights
+        std::vector<u32> offsets{0};
+        std::vector<u32> indices;
+        std::vector<float> weights;
+        std::vector<float> results;
+        int threads;
+
+        // work(begin, end, thread) over the positions split in contiguous blocks
+        template<class Work>
+        void parallel(const Work &work)const{
+            const size_t count = size(), blocks = std::max<size_t>(1, std::min<size_t>(threads, count));
+            std::vector<std::thread> pool;
+            for(size_t i = 1; i < blocks; ++i)
+                pool.emplace_back(work, count * i / blocks, count * (i + 1) / blocks, static_cast<int>(i));
+            work(0, count / blocks, 0);
+            for(std::thread &thread : pool)
+                thread.join();
+        }
+
+        static inline double sigmoid(const double k, const double eval){
+            return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+        }
+
+    public:
+        explicit TexelTuner(const int thread_count = std::thread::hardware_concurrency()):threads(std::max(1, thread_count)){}
+
+        inline size_t size()const{
+            return results.size();
+        }
+
+        /// a FEN or EPD line with the game result after it, false if either is missing or bad
+        bool add(const std::string_view line){
+            FenFields fields;
+            if(parse_fen(line, fields))
+                return false;
+            const double result = parse_game_result(fields.operations);
+            if(result < 0.0)
+                return false;
+
+            types::array<float, tune_parameters> coefficients{};
+            int phase = 0;
+            u64 pawns[2] = {0, 0};
+            for(int id = 0; id < 64; ++id){
+                const Piece piece = fields.pieces[id];
+                if(piece == No_Piece)
+                    continue;
+                const bool white = piece < B_Pawn;
+                const int type = piece % 6, sign = white ? 1 : -1;
+                const int square = white ? id ^ 56 : id;
+                if(type != W_King){
+                    coefficients[tune_material + 2 * type] += sign;
+                    coefficients[tune_material + 2 * type + 1] += sign;
+                }
+                coefficients[tune_squares + 2 * (type * 64 + square)] += sign;
+                coefficients[tune_squares + 2 * (type * 64 + square) + 1] += sign;
+                phase += phase_table[piece];
+                if(type == W_Pawn)
+                    pawns[white] |= u64(1) << id;
+            }
+            const PawnCounts counts = count_pawn_structure(pawns[White], pawns[Black]);
+            coefficients[tune_doubled] = coefficients[tune_doubled + 1] = counts.doubled;
+            coefficients[tune_isolated] = coefficients[tune_isolated + 1] = counts.isolated;
+            for(int rank = 0; rank < 8; ++rank)
+                coefficients[tune_passed + 2 * rank] = coefficients[tune_passed + 2 * rank + 1] = counts.passed[rank];
+
+            const float midlegame = std::min(phase, 24) / 24.0f, endgame = 1.0f - midlegame;
+            for(int i = 0; i < tune_parameters; ++i){
+                const float weight = coefficients[i] * ((i % 2 == 0) ? midlegame : endgame);
+                if(weight != 0.0f){
+                    indices.push_back(i);
+                    weights.push_back(weight);
+                }
+            }
+            while((indices.size() - offsets.back()) % 8 != 0){
+                indices.push_back(0);
+                weights.push_back(0.0f);
+            }
+            offsets.push_back(static_cast<u32>(indices.size()));
+            results.push_back(static_cast<float>(result));
+            return true;
+        }
+
+        /// the number of positions added, lines without a valid position and result are skipped
+        size_t load(const char *path){
+            std::ifstream in(path);
+            std::string line;
+            size_t added = 0;
+            while(std::getline(in, line))
+                added += add(line);
+            return added;
+        }
+
+        /// the tables' evaluation of a position for White, before rounding
+        inline float evaluate(const size_t position, const float *params)const{
+            const u32 begin = offsets[position], end = offsets[position + 1];
+            #ifdef __AVX2__
+            __m256 sum = _mm256_setzero_ps();
+            for(u32 i = begin; i < end; i += 8){
+                const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices.data() + i));
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_i32gather_ps(params, index, 4), _mm256_loadu_ps(weights.data() + i)));
+            }
+            const __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+            const __m128 quarter = _mm_add_ps(half, _mm_movehl_ps(half, half));
+            return _mm_cvtss_f32(_mm_add_ss(quarter, _mm_shuffle_ps(quarter, quarter, 1)));
+            #else
+            float sum = 0.0f;
+            for(u32 i = begin; i < end; ++i)
+                sum += params[indices[i]] * weights[i];
+            return sum;
+            #endif
+        }
+
+        /// mean squared difference between the results and the sigmoid of the evaluations
+        double error(const std::vector<double> &params, const double k)const{
+            const std::vector<float> values(params.begin(), params.end());
+            std::vector<double> sums(threads, 0.0);
+            parallel([&](const size_t begin, const size_t end, const int thread){
+                double sum = 0.0;
+                for(size_t i = begin; i < end; ++i){
+                    const double difference = results[i] - sigmoid(k, evaluate(i, values.data()));
+                    sum += difference * difference;
+                }
+                sums[thread] = sum;
+            });
+            double sum = 0.0;
+            for(const double thread_sum : sums)
+                sum += thread_sum;
+            return size() ? sum / size() : 0.0;
+        }
+
+        /// the gradient of error() by every parameter, every thread sums into its own copy
+        void gradient(const std::vector<double> &params, const double k, std::vector<double> &result)const{
+            const std::vector<float> values(params.begin(), params.end());
+            std::vector<std::vector<double>> sums(threads, std::vector<double>(tune_parameters, 0.0));
+            parallel([&](const size_t begin, const size_t end, const int thread){
+                std::vector<double> &sum = sums[thread];
+                for(size_t i = begin; i < end; ++i){
+                    const double s = sigmoid(k, evaluate(i, values.data()));
+                    const double factor = -2.0 * (results[i] - s) * s * (1.0 - s) * std::log(10.0) * k / 400.0;
+                    for(u32 j = offsets[i]; j < offsets[i + 1]; ++j)
+                        sum[indices[j]] += factor * weights[j];
+                }
+            });
+            result.assign(tune_parameters, 0.0);
+            for(const std::vector<double> &sum : sums){
+                for(int i = 0; i < tune_parameters; ++i)
+                    result[i] += size() ? sum[i] / size() : 0.0;
+            }
+        }
+
+        /// the scaling of the sigmoid that fits the results best for these parameters
+        double find_k(const std::vector<double> &params)const{
+            double low = 0.05, high = 5.0;
+            const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+            for(int i = 0; i < 40; ++i){
+                const double left = high - ratio * (high - low), right = low + ratio * (high - low);
+                if(error(params, left) < error(params, right))
+                    high = right;
+                else
+                    low = left;
+            }
+            return (low + high) / 2.0;
+        }
+
+        /// Adam over the whole set every epoch, report(epoch, error) every report_every epochs
+        void tune(std::vector<double> &params, const double k, const int epochs, const double rate,
+                  const std::function<void(int, double)> &report, const int report_every = 50)const{
+            constexpr double beta_1 = 0.9, beta_2 = 0.999, epsilon = 1e-8;
+            std::vector<double> moment(tune_parameters, 0.0), velocity(tune_parameters, 0.0), grad;
+            for(int epoch = 1; epoch <= epochs; ++epoch){
+                gradient(params, k, grad);
+                const double correction_1 = 1.0 - std::pow(beta_1, epoch), correction_2 = 1.0 - std::pow(beta_2, epoch);
+                for(int i = 0; i < tune_parameters; ++i){
+                    moment[i] = beta_1 * moment[i] + (1.0 - beta_1) * grad[i];
+                    velocity[i] = beta_2 * velocity[i] + (1.0 - beta_2) * grad[i] * grad[i];
+                    params[i] -= rate * (moment[i] / correction_1) / (std::sqrt(velocity[i] / correction_2) + epsilon);
+                }
+                if((epoch % report_every == 0) || (epoch == epochs))
+                    report(epoch, error(params, k));
+            }
+        }
+    };
+
+    /// Board/evaltables.hpp with the parameters rounded to centipawns
+    inline std::string write_evaltables(const std::vector<double> &params){
+        auto value = [&](const int index){ return static_cast<int>(std::lround(params[index])); };
+        std::string out = "#pragma once\n#include \"../types.hpp\"\n\n"
+                          "// written by the Texel tuner (tuner.cpp), the PeSTO values until retuned\n\n"
+                          "namespace chess{\n";
+        char buffer[64];
+        for(int type = 0; type < 6; ++type){
+            for(int phase = 0; phase < 2; ++phase){
+                out += std::string("\n    constexpr types::array<int, 64> ") + tune_piece_names[type] + (phase ? "_eg" : "_mg") + "_table{\n";
+                for(int rank = 0; rank < 8; ++rank){
+                    out += "       ";
+                    for(int file = 0; file < 8; ++file){
+                        snprintf(buffer, sizeof(buffer), " %4d,", value(tune_squares + 2 * (type * 64 + rank * 8 + file) + phase));
+                        out += buffer;
+                    }
+                    out += "\n";
+                }
+                out += "    };\n";
+            }
+        }
+        for(int phase = 0; phase < 2; ++phase){
+            out += std::string("\n    constexpr types::array<const int*, 6> square_eval_") + (phase ? "endgame" : "midlegame") + "{\n";
+            for(int type = 0; type < 6; ++type)
+                out += std::string("        ") + tune_piece_names[type] + (phase ? "_eg" : "_mg") + "_table.data()" + (type < 5 ? ",\n" : "\n");
+            out += "    };\n";
+        }
+        for(int phase = 0; phase < 2; ++phase){
+            out += std::string("\n    constexpr types::array<int, 13> material_") + (phase ? "endgame" : "midlegame") + " {\n";
+            for(int sign = 1; sign >= -1; sign -= 2){
+                out += "       ";
+                for(int type = 0; type < 5; ++type){
+                    snprintf(buffer, sizeof(buffer), " %5d,", sign * value(tune_material + 2 * type + phase));
+                    out += buffer;
+                }
+                out += (sign > 0) ? "     0,\n" : "     0, 0};\n";
+            }
+        }
+        out += "\n    constexpr int phase_table[] = {0, 1, 1, 2, 4, 0,\n"
+               "                                   0, 1, 1, 2, 4, 0, 0};\n";
+
+        out += "\n    // pawn structure, cached by the pawn hash table\n";
+        const char *names[] = {"doubled_pawn", "isolated_pawn"};
+        for(int term = 0; term < 2; ++term){
+            for(int phase = 0; phase < 2; ++phase){
+                snprintf(buffer, sizeof(buffer), " = %d;\n", value((term ? tune_isolated : tune_doubled) + phase));
+                out += std::string("    constexpr int ") + names[term] + (phase ? "_endgame" : "_midlegame") + buffer;
+            }
+        }
+        out += "\n    // by rank from the pawn's own side\n";
+        for(int phase = 0; phase < 2; ++phase){
+            out += std::string("    constexpr types::array<int, 8> passed_pawn_") + (phase ? "endgame   {" : "midlegame {");
+            for(int rank = 0; rank < 8; ++rank){
+                snprintf(buffer, sizeof(buffer), "%s%d", rank ? ", " : "", value(tune_passed + 2 * rank + phase));
+                out += buffer;
+            }
+            out += "};\n";
+        }
+        out += "}\n";
+        return out;
+    }
+}
@@ -0,0 +1,346 @@
+#pragma once
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include "movegen.hpp"
+#include "fenView.hpp"
+#include "book.hpp"
+#include "bench.hpp"
+#include "parallel.hpp"
+#include "../Board/board.hpp"
+#include "../ai.hpp"
+
+namespace chess
+{
+    inline types::string move_to_uci(const Move_full_info move)
+    {
+        if (move.from_square == No_Square)
+            return "0000";
+        types::string str = square_to_str(static_cast<Square>(move.from_square)) + square_to_str(static_cast<Square>(move.to_square));
+        if (move.special == SP_Promotion)
+            str += "nbrq"[move.promotion];
+        return str;
+    }
+
+    /// "mate <moves>" in the mate band, negative when the side to move gets mated, "cp <x>" otherwise;
+    /// a table win is shown as 20000 cp less its distance to zeroing, so it can't be read as a mate
+    inline std::string score_to_uci(const int score)
+    {
+        if (std::abs(score) >= mate_bound)
+        {
+            const int plies = mate_score - std::abs(score);
+            return "mate " + std::to_string((score > 0) ? (plies + 1) / 2 : -(plies / 2));
+        }
+        if (std::abs(score) > tb_win - 256)
+            return "cp " + std::to_string((score > 0) ? score - tb_win + 20'000 : score + tb_win - 20'000);
+        return "cp " + std::to_string(score);
+    }
+
+    /// UCI front end, the search runs on its own thread so `stop` is answered while searching
+    class UCI
+    {
+    private:
+        const std::string START_POS = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+        Board board;
+        Movelist<5000> list;
+        Movelist_ref list_ref{list};
+        AI ai{board, list_ref};
+        PolyglotBook book;
+        Tablebases tablebases;
+        NnueNetwork network;
+        ParallelSearch parallel;
+
+        std::thread search_thread;
+        std::atomic<bool> infinite_search{false};
+        std::mutex output_mutex;
+        std::ostream &out;
+
+        int hash_size_mb = 16;
+        int threads = 1;
+
+        void send(const std::string &line)
+        {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            out << line << std::endl;
+        }
+
+        /// the node signature and speed of the bench positions, see run_bench
+        void bench(const int depth)
+        {
+            const BenchResult result = run_bench(depth, [this](const int index, const char *fen, const int64_t nodes)
+                                                 { send("info string bench " + std::to_string(index + 1) + " " + fen + " nodes " + std::to_string(nodes)); });
+            send("info string bench depth " + std::to_string(depth) + " nodes " + std::to_string(result.nodes) + " time " +
+                 std::to_string(result.time_ms) + " nps " + std::to_string(result.nps()));
+        }
+
+        void stop_search()
+        {
+            infinite_search = false;
+            ai.request_stop();
+            if (search_thread.joinable())
+                search_thread.join();
+        }
+
+        template <Color clr>
+        bool apply_move(const std::string &str)
+        {
+            Movelist_ref moves(list);
+            Movegen generator(board, moves);
+            generator.gen_all_moves<clr>();
+            for (Move_full_info *i = moves.begin; i != moves.end; ++i)
+            {
+                if (move_to_uci(*i) == str)
+                {
+                    board.unstable_make_move<clr>(*i);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // position [startpos | fen <fen>] [moves <move>...]
+        void position(std::istringstream &in)
+        {
+            std::string token, fen;
+            in >> token;
+            if (token == "startpos")
+            {
+                fen = START_POS;
+                in >> token;
+            }
+            else if (token == "fen")
+            {
+                while ((in >> token) && (token != "moves"))
+                    fen += token + " ";
+            }
+            else
+                return;
+            if (const FenError error = parse_fen(fen, board))
+            {
+                send("info string bad fen, " + std::string(fen_error_message(error.code)) + " at " + std::to_string(error.position));
+                return;
+            }
+
+            while (in >> token)
+            {
+                if (token == "moves")
+                    continue;
+                const bool applied = board.get_turn() ? apply_move<White>(token) : apply_move<Black>(token);
+                if (!applied)
+                {
+                    send("info string illegal move " + token);
+                    return;
+                }
+            }
+        }
+
+        // go [depth <d>] [nodes <n>] [movetime <ms>] [wtime <ms>] [btime <ms>] [winc <ms>] [binc <ms>] [movestogo <n>] [infinite]
+        void go(std::istringstream &in)
+        {
+            SearchLimits limits;
+            int64_t time = 0, increment = 0, moves_to_go = 30;
+            std::string token;
+            while (in >> token)
+            {
+                if (token == "depth")
+                    in >> limits.depth;
+                else if (token == "nodes")
+                    in >> limits.nodes;
+                else if (token == "movetime")
+                    in >> limits.movetime;
+                else if (token == "infinite")
+                    limits.infinite = true;
+                else if (token == "movestogo")
+                    in >> moves_to_go;
+                else if ((token == "wtime") || (token == "btime"))
+                {
+                    int64_t value;
+                    in >> value;
+                    if ((token == "wtime") == static_cast<bool>(board.get_turn()))
+                        time = value;
+                }
+                else if ((token == "winc") || (token == "binc"))
+                {
+                    int64_t value;
+                    in >> value;
+                    if ((token == "winc") == static_cast<bool>(board.get_turn()))
+                        increment = value;
+                }
+            }
+            if ((time != 0) && (limits.movetime == 0))
+            {
+                // an even share of the clock, never closer than 50 ms to the flag
+                limits.movetime = std::max<int64_t>(1, std::min(time / std::max<int64_t>(1, moves_to_go) + increment / 2, time - 50));
+            }
+
+            if (book.is_open() && !limits.infinite)
+            {
+                const u64 random = std::chrono::steady_clock::now().time_since_epoch().count();
+                const Move_full_info book_move = book.probe(board, Movelist_ref(list), random);
+                if (book_move.from_square != No_Square)
+                {
+                    send("info string book move");
+                    send("bestmove " + move_to_uci(book_move));
+                    return;
+                }
+            }
+
+            infinite_search = limits.infinite;
+            ai.clear_stop();
+            search_thread = std::thread([this, limits]()
+            {
+                #ifdef MAESTRO_PROFILE
+                profile_thread.clear();
+                #endif
+                Move_full_info best_move;
+                std::tie(best_move, std::ignore) = parallel.search(ai, board, limits, [this](const SearchInfo &info)
+                {
+                    std::ostringstream line;
+                    line << "info depth " << info.depth << " score " << score_to_uci(info.score) << " nodes " << info.nodes
+                         << " nps " << (info.nodes * 1000 / std::max<int64_t>(1, info.time)) << " time " << info.time
+                         << " pv " << move_to_uci(info.best_move);
+                    send(line.str());
+                    if (info.eval_cache_probes != 0)
+                        send("info string eval cache hits " + std::to_string(info.eval_cache_hits * 1000 / info.eval_cache_probes) + " permill of " +
+                             std::to_string(info.eval_cache_probes));
+                    if constexpr (SearchStats::enabled)
+                        send("info string " + ai.get_stats().uci_info());
+                });
+                // "go infinite" must not answer before "stop"
+                while (infinite_search)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                #ifdef MAESTRO_PROFILE
+                Profile profile = profile_thread;
+                profile += parallel.helper_profile();
+                std::istringstream report(profile.report());
+                for (std::string line; std::getline(report, line);)
+                    send("info string " + line);
+                #endif
+                send("bestmove " + move_to_uci(best_move));
+            });
+        }
+
+        // setoption name <id> value <x>
+        void set_option(std::istringstream &in)
+        {
+            std::string token, name, value;
+            in >> token >> name >> token;
+            std::getline(in >> std::ws, value);
+            if (name == "Hash")
+            {
+                hash_size_mb = std::max(1, std::atoi(value.c_str()));
+                parallel.set_hash_size(hash_size_mb);
+            }
+            else if (name == "EvalCache")
+            {
+                ai.set_eval_cache_size(std::max(0, std::atoi(value.c_str())));
+                parallel.set_eval_cache_size(std::max(0, std::atoi(value.c_str())));
+            }
+            else if (name == "Threads")
+            {
+                threads = std::clamp(std::atoi(value.c_str()), 1, 256);
+                parallel.set_threads(threads);
+            }
+            else if (name == "BookFile")
+            {
+                if (value.empty() || (value == "<empty>"))
+                    book.close();
+                else if (!book.open(value.c_str()))
+                    send("info string can't open book " + value);
+            }
+            else if (name == "EvalFile")
+            {
+                // an empty or bad file goes back to the tables
+                if (!value.empty() && (value != "<empty>") && !network.load(value.c_str()))
+                    send("info string can't load network " + value);
+                else if (value.empty() || (value == "<empty>"))
+                    network = NnueNetwork();
+                ai.set_network(network.is_loaded() ? &network : nullptr);
+                parallel.set_network(network.is_loaded() ? &network : nullptr);
+            }
+            else if (name == "TablebasePath")
+            {
+                // the ".mtb" files of the directory, tables are only ever added
+                const int loaded = (value.empty() || (value == "<empty>")) ? 0 : tablebases.load_directory(value.c_str());
+                send("info string " + std::to_string(loaded) + " tablebases loaded");
+                ai.set_tablebases(tablebases.size() != 0 ? &tablebases : nullptr);
+                parallel.set_tablebases(tablebases.size() != 0 ? &tablebases : nullptr);
+            }
+        }
+
+    public:
+        UCI(std::ostream &output = std::cout) : out(output)
+        {
+            parse_fen(START_POS, board);
+        }
+
+        ~UCI()
+        {
+            stop_search();
+        }
+
+        int get_hash_size_mb() const { return hash_size_mb; }
+        int get_threads() const { return threads; }
+
+        void loop(std::istream &in = std::cin)
+        {
+            std::string line;
+            while (std::getline(in, line))
+            {
+                std::istringstream command_in(line);
+                std::string command;
+                command_in >> command;
+
+                if (command == "uci")
+                {
+                    send("id name chessMaestro");
+                    send("id author chessMaestro team");
+                    send("option name Hash type spin default 16 min 1 max 65536");
+                    send("option name EvalCache type spin default 4 min 0 max 1024");
+                    send("option name Threads type spin default 1 min 1 max 256");
+                    send("option name BookFile type string default <empty>");
+                    send("option name TablebasePath type string default <empty>");
+                    send("option name EvalFile type string default <empty>");
+                    send("uciok");
+                }
+                else if (command == "isready")
+                    send("readyok");
+                else if (command == "ucinewgame")
+                {
+                    stop_search();
+                    parse_fen(START_POS, board);
+                    parallel.clear();
+                }
+                else if (command == "setoption")
+                {
+                    stop_search();
+                    set_option(command_in);
+                }
+                else if (command == "position")
+                {
+                    stop_search();
+                    position(command_in);
+                }
+                else if (command == "go")
+                {
+                    stop_search();
+                    go(command_in);
+                }
+                else if (command == "stop")
+                    stop_search();
+                else if (command == "bench")
+                {
+                    stop_search();
+                    int depth = bench_default_depth;
+                    command_in >> depth;
+                    bench(depth);
+                }
+                else if (command == "quit")
+                    break;
+            }
+            stop_search();
+        }
+    };
+}
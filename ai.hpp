@@ -1,27 +1,327 @@
 #pragma once 
 #include"Board/board.hpp"
 #include "MainLogic/movegen.hpp"
+#include "MainLogic/tablebase.hpp"
+#include "MainLogic/evalcache.hpp"
+#include "MainLogic/searchstats.hpp"
+#include "MainLogic/transposition.hpp"
+#include "Board/nnue.hpp"
+#ifdef MAESTRO_COPY_MAKE
+#include "Board/copymake.hpp"
+#endif
 #include <cassert>
+#include <atomic>
+#include <chrono>
+#include <functional>
 namespace chess{
+
+    /// 0 means no limit
+    struct SearchLimits{
+        int depth = 64;
+        int64_t nodes = 0;
+        int64_t movetime = 0;
+        bool infinite = false;
+    };
+
+    /// reported after every finished iteration
+    struct SearchInfo{
+        int depth;
+        int score;
+        int64_t nodes;
+        int64_t time;
+        Move_full_info best_move;
+        int64_t eval_cache_probes;
+        int64_t eval_cache_hits;
+    };
+
+    /// a mate scores mate_score less the plies to it from the root, anything past mate_bound is a mate
+    constexpr int mate_score = 300'000;
+    constexpr int mate_bound = mate_score - 256;
+    /// a won table position scores below any mate found by the search, the nearer the zeroing move the better
+    constexpr int tb_win = 200'000;
+
     class AI{
         Board &brd;
         Movelist_ref &global_list_ref;
+
+        std::atomic<bool> stop{false};
+        SearchLimits limits;
+        std::chrono::steady_clock::time_point start_time;
+        #ifdef MAESTRO_COPY_MAKE
+        BoardStack<256> board_stack;
+        #endif
+        PawnHashTable pawn_table;
+        EvalCache eval_cache;
+        // the Zobrist hash of brd, kept by make_move/undo_move for the eval cache
+        u64 hash = 0;
+        int64_t eval_cache_probes = 0;
+        int64_t eval_cache_hits = 0;
+        NnueStack<256> nnue;
+        SearchStats stats;
+        // shared with the other threads of a parallel search, nullptr searches without one
+        TranspositionTable *tt = nullptr;
+        const Tablebases *tablebases = nullptr;
+        // kept by the searches for the tablebase probe
+        int piece_count = 0;
+        // from the root, kept by make_move/undo_move for the mate distance
+        int ply = 0;
+
+        /// make/undo by default, -DMAESTRO_COPY_MAKE switches to copy-make,
+        /// the Accumulator is then unused; perft and hashtest leave the hash and the network alone
+        template<Color clr, bool searching = true>
+        inline Accumulator make_move(const Move_full_info move){
+            if constexpr(searching){
+                hash = brd.get_hash<clr>(hash, move);
+                if(nnue.enabled())
+                    nnue.push<clr>(brd, move);
+                ++ply;
+            }
+            #ifdef MAESTRO_COPY_MAKE
+            board_stack.push(brd);
+            brd.unstable_make_move<clr>(move);
+            return {};
+            #else
+            return brd.unstable_make_move<clr>(move);
+            #endif
+        }
+
+        template<Color clr, bool searching = true>
+        inline void undo_move(const Move_full_info move, const Accumulator acc){
+            #ifdef MAESTRO_COPY_MAKE
+            board_stack.pop(brd);
+            #else
+            brd.unstable_undo_move<clr>(move, acc);
+            #endif
+            // the hash update is a xor over the position before the move, it undoes itself
+            if constexpr(searching){
+                hash = brd.get_hash<clr>(hash, move);
+                if(nnue.enabled())
+                    nnue.pop();
+                --ply;
+            }
+        }
+
+        inline void start_evaluation(){
+            hash = brd.get_hash();
+            ply = 0;
+            if(nnue.enabled())
+                nnue.reset(brd);
+            eval_cache_probes = 0;
+            eval_cache_hits = 0;
+            stats.reset();
+        }
+
+        /// the network if one is set, the tables otherwise
+        template<Color clr>
+        inline int static_eval(){
+            return nnue.enabled() ? nnue.evaluate<clr>(brd) : brd.eval<clr>(&pawn_table);
+        }
+
+        /// static_eval<clr>() through the eval cache, which keeps it from White's side
+        template<Color clr>
+        inline int evaluate(){
+            if(!eval_cache.enabled())
+                return static_eval<clr>();
+            ++eval_cache_probes;
+            int score;
+            if(eval_cache.probe(hash, score))
+                ++eval_cache_hits;
+            else{
+                score = clr ? static_eval<clr>() : -static_eval<clr>();
+                eval_cache.store(hash, score);
+            }
+            if constexpr(clr)
+                return score;
+            else
+                return -score;
+        }
+
+        inline int64_t elapsed_ms()const{
+            return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time).count();
+        }
+
+        inline int64_t elapsed_us()const{
+            return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+        }
+
+        // the clock is read once per 1024 leaves
+        inline void check_limits(){
+            if((all_nodes & 1023) != 0)
+                return;
+            if((limits.nodes != 0) && (all_nodes >= limits.nodes))
+                stop = true;
+            if((limits.movetime != 0) && (elapsed_ms() >= limits.movetime))
+                stop = true;
+        }
+
+        inline bool stopped()const{
+            return stop.load(std::memory_order_relaxed);
+        }
+
+        inline bool is_capture(const Move_full_info move)const{
+            return (brd[move.to_square] != No_Piece) || (move.special == SP_en_passant);
+        }
+
+        void count_pieces(){
+            piece_count = 0;
+            for(int i = 0; i < 64; ++i)
+                piece_count += brd[i] != No_Piece;
+        }
+
+        inline bool probe_tablebases(int &score)const{
+            if((tablebases == nullptr) || (piece_count > tablebases->get_max_pieces()))
+                return false;
+            const TbProbe probe = tablebases->probe(brd);
+            if(!probe.found)
+                return false;
+            score = (probe.wdl == TB_Win) ? tb_win - probe.dtz : (probe.wdl == TB_Loss) ? -tb_win + probe.dtz : 0;
+            return true;
+        }
+
+        // the table keeps a mate from the node it is stored at, so it stays right when reached by another path
+        inline int score_to_tt(const int score)const{
+            return (score >= mate_bound) ? score + ply : (score <= -mate_bound) ? score - ply : score;
+        }
+
+        inline int score_from_tt(const int score)const{
+            return (score >= mate_bound) ? score - ply : (score <= -mate_bound) ? score + ply : score;
+        }
+
+        // shallower nodes are not worth the atomics of the being-searched marks
+        static constexpr int abdada_min_depth = 2;
+
+        /// The moves of a node with the table set: the stored move first, then ABDADA, a sibling that another
+        /// thread is inside of is put off until the others are done, so the threads spread over the tree.
+        /// The first move is never put off. Stores the result unless the search was stopped.
+        template<Color clr>
+        int search_moves_shared(const int d, int alpha, const int beta, Movelist_ref list_ref, const Move tt_move, Move_full_info &best_move){
+            const int original_alpha = alpha;
+            if(tt_move != 0){
+                Move_full_info *found = std::find_if(list_ref.begin, list_ref.end, [tt_move](const Move_full_info move){ return move.to_move() == tt_move; });
+                if(found != list_ref.end)
+                    std::rotate(list_ref.begin, found, found + 1);
+            }
+            Move_full_info deferred[256];
+            int deferred_count = 0;
+            int searched = 0;
+            // true once the node is done, by a cutoff or a stop
+            auto search_move = [&](const Move_full_info move, const bool may_defer){
+                const u64 child = brd.get_hash<clr>(hash, move);
+                if(may_defer && tt->is_searching(child)){
+                    deferred[deferred_count++] = move;
+                    return false;
+                }
+                const bool capture = is_capture(move);
+                piece_count -= capture;
+                tt->start_search(child);
+                const Accumulator acc = make_move<clr>(move);
+
+                const int loc_eval = -negamax_ab<change_color(clr)>(d - 1, -beta, -alpha, list_ref.get_ref());
+
+                undo_move<clr>(move, acc);
+                tt->finish_search(child);
+                piece_count += capture;
+                if(stopped())
+                    return true;
+                if(loc_eval >= beta){
+                    stats.count_cutoff(searched);
+                    best_move = move;
+                    alpha = beta;
+                    return true;
+                }
+                ++searched;
+                if(loc_eval > alpha){
+                    best_move = move;
+                    alpha = loc_eval;
+                }
+                return false;
+            };
+            bool done = false;
+            for(Move_full_info *i = list_ref.begin; (i != list_ref.end) && !done; ++i)
+                done = search_move(*i, (i != list_ref.begin) && (d >= abdada_min_depth));
+            for(int i = 0; (i < deferred_count) && !done; ++i)
+                done = search_move(deferred[i], false);
+
+            if(!stopped()){
+                const TTBound bound = (alpha >= beta) ? TT_Lower : (alpha > original_alpha) ? TT_Exact : TT_Upper;
+                tt->store(hash, score_to_tt(alpha), d, bound, (best_move.from_square == No_Square) ? 0 : best_move.to_move());
+            }
+            return alpha;
+        }
     public:
         int64_t all_nodes;
         AI(Board &board, Movelist_ref &movelist_ref):brd(board), global_list_ref(movelist_ref){}
+
+        inline const PawnHashTable& get_pawn_table()const{
+            return pawn_table;
+        }
+
+        /// 0 turns the cache off, not during a search
+        void set_eval_cache_size(const size_t megabytes){
+            eval_cache.resize(megabytes);
+        }
+
+        /// the network evaluates instead of the tables, nullptr goes back to them, not during a search
+        void set_network(const NnueNetwork *network){
+            nnue.set_network(network);
+            eval_cache.clear();
+        }
+
+        inline bool uses_network()const{
+            return nnue.enabled();
+        }
+
+        inline const EvalCache& get_eval_cache()const{
+            return eval_cache;
+        }
+
+        /// over the last search
+        inline int64_t get_eval_cache_probes()const{ return eval_cache_probes; }
+        inline int64_t get_eval_cache_hits()const{ return eval_cache_hits; }
+        inline double eval_cache_hit_rate()const{ return eval_cache_probes ? double(eval_cache_hits) / eval_cache_probes : 0.0; }
+
+        /// of the last search, also while it runs from the report callback
+        inline const SearchStats& get_stats()const{
+            return stats;
+        }
+
+        /// safe to call from another thread, the search unwinds within a few thousand nodes
+        void request_stop(){
+            stop = true;
+        }
+
+        /// before a new search is started, not from inside one
+        void clear_stop(){
+            stop = false;
+        }
+
+        /// probed by negamax_ab once few enough pieces are left, nullptr turns it off
+        void set_tablebases(const Tablebases *tbs){
+            tablebases = tbs;
+        }
+
+        /// negamax_ab stores its results there and marks the nodes it is in for the other threads, nullptr turns it off
+        void set_transposition_table(TranspositionTable *table){
+            tt = table;
+        }
+
+        /// the board becomes a copy of position, for the helper threads of a parallel search
+        void set_position(const Board &position){
+            brd = position;
+        }
         
         template<Color clr>
         int negamax(int d, Movelist_ref list_ref){
-            
+            stats.count_node();
             if(d == 0){
                 ++all_nodes;
-                return brd.eval<clr>();
+                return evaluate<clr>();
             }
             Movegen generator(brd, list_ref);
 
             PositionState state = generator.gen_all_moves<clr>();
             if(list_ref.no_moves()){
-                constexpr int mate = -300'000;
+                const int mate = -mate_score + ply;
                 //++all_nodes;
 
                 if(state >= check)//  >= check means check or double check 
@@ -37,11 +337,11 @@ namespace chess{
 
             for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
 
-                const Accumulator acc = brd.unstable_make_move<clr>(*i);
+                const Accumulator acc = make_move<clr>(*i);
                 
                 int loc_eval = -negamax<change_color(clr)>(d - 1, list_ref.get_ref());
             
-                brd.unstable_undo_move<clr>(*i, acc);
+                undo_move<clr>(*i, acc);
                 
                 if(loc_eval > alpha){
                     alpha = loc_eval;
@@ -54,12 +354,14 @@ namespace chess{
         template<Color clr>
         std::tuple<Move_full_info, int> best_move_negamax(int d){
             all_nodes = 0;
+            start_time = std::chrono::steady_clock::now();
+            start_evaluation();
             Movegen generator(brd, global_list_ref);
 
             PositionState state = generator.gen_all_moves<clr>();
 
             
-            if((d == 0) || (global_list_ref.no_moves()))return {{}, 0};
+            if((d == 0) || (global_list_ref.no_moves()))return {No_Move, 0};
 
             constexpr int inf = 1'000'000;
 
@@ -68,11 +370,11 @@ namespace chess{
             Move_full_info best_move;
             
             for (Move_full_info *i = global_list_ref.begin; i != global_list_ref.end; ++i){
-                const Accumulator acc = brd.unstable_make_move<clr>(*i);
+                const Accumulator acc = make_move<clr>(*i);
                 
                 int loc_eval = -negamax<change_color(clr)>(d - 1, global_list_ref.get_ref());
             
-                brd.unstable_undo_move<clr>(*i, acc);
+                undo_move<clr>(*i, acc);
                 
                 if(loc_eval > alpha){
                     best_move = *i;
@@ -80,6 +382,7 @@ namespace chess{
                 }
 
             }
+            stats.finish_iteration(d, elapsed_us());
             
             return {best_move, alpha};
         } 
@@ -93,7 +396,8 @@ namespace chess{
         template<Color clr>
         int q_search_ab(int alpha, int beta, Movelist_ref list_ref){
             ++all_nodes;
-            int eval = brd.eval<clr>();
+            stats.count_qnode();
+            int eval = evaluate<clr>();
 
             if(eval >= beta)
                 return beta;
@@ -105,7 +409,7 @@ namespace chess{
             PositionState state = generator.gen_all_moves<clr>();
 
             if(list_ref.no_moves()){
-                constexpr int mate = -300'000;
+                const int mate = -mate_score + ply;
                 ++all_nodes;
                 if(state >= check)
                     return mate;
@@ -118,14 +422,15 @@ namespace chess{
                 if((brd[i->to_square] == No_Piece) && (i->special != SP_en_passant))
                     continue;
                 
-                const Accumulator acc = brd.unstable_make_move<clr>(*i);
+                const Accumulator acc = make_move<clr>(*i);
                 
                 eval = -q_search_ab<change_color(clr)>(-beta, -alpha, list_ref.get_ref());
             
-                brd.unstable_undo_move<clr>(*i, acc);    
+                undo_move<clr>(*i, acc);    
 
                 
                 if(eval >= beta){
+                    stats.count_cutoff(i - list_ref.begin);
                     return beta;
                 }
 
@@ -139,17 +444,37 @@ namespace chess{
 
         template<Color clr>
         int negamax_ab(int d, int alpha, int beta, Movelist_ref list_ref){
+            if(stopped())
+                return 0;
+            stats.count_node();
+            int tb_score;
+            if(probe_tablebases(tb_score)){
+                ++all_nodes;
+                return tb_score;
+            }
             if(d == 0){
                 ++all_nodes;
+                check_limits();
                 //return q_search_ab<clr>(alpha, beta, list_ref);
-                return brd.eval<clr>();
+                return evaluate<clr>();
+            }
+            TTProbe entry;
+            if(tt != nullptr){
+                entry = tt->probe(hash);
+                entry.score = score_from_tt(entry.score);
+                stats.count_tt_probe(entry.found);
+                if(entry.found && (entry.depth >= d) && ((entry.bound == TT_Exact) || ((entry.bound == TT_Lower) && (entry.score >= beta)) ||
+                                                          ((entry.bound == TT_Upper) && (entry.score <= alpha)))){
+                    stats.count_tt_cutoff();
+                    return std::clamp(entry.score, alpha, beta);
+                }
             }
             Movegen generator(brd, list_ref);
 
             PositionState state = generator.gen_all_moves<clr>();
 
             if(list_ref.no_moves()){
-                constexpr int mate = -300'000;
+                const int mate = -mate_score + ply;
                 ++all_nodes;
                 if(state >= check)
                     return mate;
@@ -158,15 +483,24 @@ namespace chess{
                 return stalemate;
             }
 
+            if(tt != nullptr){
+                Move_full_info best_move;
+                return search_moves_shared<clr>(d, alpha, beta, list_ref, entry.move, best_move);
+            }
+
             for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
-                const Accumulator acc = brd.unstable_make_move<clr>(*i);
+                const bool capture = is_capture(*i);
+                piece_count -= capture;
+                const Accumulator acc = make_move<clr>(*i);
                 
                 const int loc_eval = -negamax_ab<change_color(clr)>(d - 1, -beta, -alpha, list_ref.get_ref());
             
-                brd.unstable_undo_move<clr>(*i, acc);    
+                undo_move<clr>(*i, acc);    
+                piece_count += capture;
 
                 
                 if(loc_eval >= beta){
+                    stats.count_cutoff(i - list_ref.begin);
                     return beta;
                 }
 
@@ -182,13 +516,16 @@ namespace chess{
         template<Color clr>
         std::tuple<Move_full_info, int> best_move_ab(int d){
             all_nodes = 0;
+            start_time = std::chrono::steady_clock::now();
+            count_pieces();
+            start_evaluation();
             Movegen generator(brd, global_list_ref);
 
             PositionState state = generator.gen_all_moves<clr>();
 
             //brd.sort_moves<clr>(list_ref);
             
-            if((d == 0) || (global_list_ref.no_moves()))return {{}, 0};
+            if((d == 0) || (global_list_ref.no_moves()))return {No_Move, 0};
 
             constexpr int inf = 1'000'000'000;
 
@@ -199,11 +536,14 @@ namespace chess{
             
             for (Move_full_info *i = global_list_ref.begin; i != global_list_ref.end; ++i){
 
-                const Accumulator acc = brd.unstable_make_move<clr>(*i);
+                const bool capture = is_capture(*i);
+                piece_count -= capture;
+                const Accumulator acc = make_move<clr>(*i);
                 
                 int loc_eval = -negamax_ab<change_color(clr)>(d - 1, -inf, -alpha, global_list_ref.get_ref());
             
-                brd.unstable_undo_move<clr>(*i, acc);
+                undo_move<clr>(*i, acc);
+                piece_count += capture;
                 
                 if(loc_eval > alpha){
                     best_move = *i;
@@ -211,6 +551,7 @@ namespace chess{
                 }
 
             }
+            stats.finish_iteration(d, elapsed_us());
             
             return {best_move, alpha};
         }
@@ -219,6 +560,71 @@ namespace chess{
             return (brd.get_turn() ? best_move_ab<White>(d) : best_move_ab<Black>(d));
         }
 
+        /// iterative deepening over negamax_ab until a limit is hit or stop is requested,
+        /// an unfinished iteration is thrown away
+        template<Color clr>
+        std::tuple<Move_full_info, int> search(const SearchLimits &search_limits, const std::function<void(const SearchInfo&)> &report){
+            limits = search_limits;
+            start_time = std::chrono::steady_clock::now();
+            all_nodes = 0;
+            count_pieces();
+            start_evaluation();
+
+            Movegen generator(brd, global_list_ref);
+            generator.gen_all_moves<clr>();
+            if(global_list_ref.no_moves())
+                return {No_Move, 0};
+
+            constexpr int inf = 1'000'000'000;
+            Move_full_info best_move = global_list_ref[0];
+            int best_eval = 0;
+
+            for(int d = 1; (d <= limits.depth) && !stopped(); ++d){
+                // the best move of the last iteration goes first
+                std::iter_swap(global_list_ref.begin, std::find(global_list_ref.begin, global_list_ref.end, best_move));
+
+                int alpha = -inf;
+                Move_full_info iteration_best_move;
+                if(tt != nullptr)
+                    alpha = search_moves_shared<clr>(d, -inf, inf, global_list_ref, 0, iteration_best_move);
+                else{
+                    for (Move_full_info *i = global_list_ref.begin; i != global_list_ref.end; ++i){
+                        const bool capture = is_capture(*i);
+                        piece_count -= capture;
+                        const Accumulator acc = make_move<clr>(*i);
+
+                        const int loc_eval = -negamax_ab<change_color(clr)>(d - 1, -inf, -alpha, global_list_ref.get_ref());
+
+                        undo_move<clr>(*i, acc);
+                        piece_count += capture;
+
+                        if(stopped())
+                            break;
+
+                        if(loc_eval > alpha){
+                            iteration_best_move = *i;
+                            alpha = loc_eval;
+                        }
+                    }
+                }
+                if(stopped())
+                    break;
+
+                best_move = iteration_best_move;
+                best_eval = alpha;
+                stats.finish_iteration(d, elapsed_us());
+                report({d, best_eval, all_nodes, elapsed_ms(), best_move, eval_cache_probes, eval_cache_hits});
+
+                if((limits.nodes != 0) && (all_nodes >= limits.nodes))
+                    break;
+            }
+            return {best_move, best_eval};
+        }
+
+        std::tuple<Move_full_info, int> search(const SearchLimits &search_limits, const std::function<void(const SearchInfo&)> &report){
+            return (brd.get_turn() ? search<White>(search_limits, report) : search<Black>(search_limits, report));
+        }
+
         template<Color color>
         int64_t perft(int d, Movelist_ref list_ref){
             if(d == 0)
@@ -230,11 +636,11 @@ namespace chess{
             
             int nodes = 0;
             for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
-                const Accumulator acc = brd.unstable_make_move<color>(*i);
+                const Accumulator acc = make_move<color, false>(*i);
                 
                 nodes += perft<change_color(color)>(d - 1, list_ref.get_ref());
                 
-                brd.unstable_undo_move<color>(*i, acc);
+                undo_move<color, false>(*i, acc);
             }
             return nodes;
         }
@@ -248,6 +654,7 @@ namespace chess{
         template<Color color>
         int64_t hashtest(int d, Movelist_ref list_ref, u64 hash){
             assert(hash == brd.get_hash());
+            assert(brd.get_pawn_key() == brd.compute_pawn_key());
             if(d == 0)
                 return 1;
             
@@ -258,11 +665,11 @@ namespace chess{
             int nodes = 0;
             for (Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
                 const u64 new_hash = brd.get_hash<color>(hash, *i);
-                const Accumulator acc = brd.unstable_make_move<color>(*i);
+                const Accumulator acc = make_move<color, false>(*i);
                 
                 nodes += hashtest<change_color(color)>(d - 1, list_ref.get_ref(), new_hash);
                 
-                brd.unstable_undo_move<color>(*i, acc);
+                undo_move<color, false>(*i, acc);
             }
             return nodes;
         }
@@ -0,0 +1,151 @@
+#include "MainLogic/fenView.hpp"
+#include "Board/board.hpp"
+#include "ai.hpp"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace chess;
+
+// batch [-d depth] [-n nodes] [-t threads] [-s] [file]
+// reads one FEN or EPD per line from the file or stdin and prints
+// "<line> bestmove <move> score <cp> nodes <n> time <ms>" in the order the searches finish,
+// a line that is not a valid FEN gets "<line> error <reason> at <offset>",
+// -s follows every search with "<line> stats <json>"
+
+istream *input = &cin;
+mutex input_mutex;
+mutex output_mutex;
+int64_t next_line = 0;
+bool print_stats = false;
+#ifdef MAESTRO_PROFILE
+// the workers' counters, added up as they finish
+Profile profile;
+#endif
+
+struct Worker{
+    Board brd;
+    Movelist<5000> list;
+    Movelist_ref list_ref{list};
+    AI bot{brd, list_ref};
+    string fen;
+    array<char, 160> out;
+
+    // false when the input is over
+    bool next_fen(int64_t &line){
+        lock_guard<mutex> lock(input_mutex);
+        while(getline(*input, fen)){
+            line = next_line++;
+            if(!fen.empty())
+                return true;
+        }
+        return false;
+    }
+
+    void write(const int64_t line, const Move_full_info move, const int score, const int64_t nodes, const int64_t time){
+        char *ptr = out.data();
+        char *end = out.data() + out.size();
+        ptr = to_chars(ptr, end, line).ptr;
+        const char *bestmove = " bestmove ";
+        ptr = copy(bestmove, bestmove + strlen(bestmove), ptr);
+        *ptr++ = 'a' + move.from_square % 8;
+        *ptr++ = '1' + move.from_square / 8;
+        *ptr++ = 'a' + move.to_square % 8;
+        *ptr++ = '1' + move.to_square / 8;
+        if(move.special == SP_Promotion)
+            *ptr++ = "nbrq"[move.promotion];
+        const char *score_str = " score ";
+        ptr = copy(score_str, score_str + strlen(score_str), ptr);
+        ptr = to_chars(ptr, end, score).ptr;
+        const char *nodes_str = " nodes ";
+        ptr = copy(nodes_str, nodes_str + strlen(nodes_str), ptr);
+        ptr = to_chars(ptr, end, nodes).ptr;
+        const char *time_str = " time ";
+        ptr = copy(time_str, time_str + strlen(time_str), ptr);
+        ptr = to_chars(ptr, end, time).ptr;
+        *ptr++ = '\n';
+
+        lock_guard<mutex> lock(output_mutex);
+        fwrite(out.data(), 1, ptr - out.data(), stdout);
+    }
+
+    void run(const SearchLimits limits){
+        const function<void(const SearchInfo&)> no_report = [](const SearchInfo&){};
+        int64_t line;
+        while(next_fen(line)){
+            if(const FenError error = parse_fen(fen, brd)){
+                lock_guard<mutex> lock(output_mutex);
+                fprintf(stdout, "%lld error %s at %d\n", static_cast<long long>(line), fen_error_message(error.code), error.position);
+                continue;
+            }
+            bot.clear_stop();
+            const auto start = chrono::steady_clock::now();
+            Move_full_info move;
+            int score;
+            tie(move, score) = bot.search(limits, no_report);
+            const auto end = chrono::steady_clock::now();
+            if(move.from_square == No_Square){
+                lock_guard<mutex> lock(output_mutex);
+                fprintf(stdout, "%lld bestmove 0000\n", static_cast<long long>(line));
+                continue;
+            }
+            write(line, move, score, bot.all_nodes, chrono::duration_cast<chrono::milliseconds>(end - start).count());
+            if(print_stats){
+                const string json = bot.get_stats().json();
+                lock_guard<mutex> lock(output_mutex);
+                fprintf(stdout, "%lld stats %s\n", static_cast<long long>(line), json.c_str());
+            }
+        }
+        #ifdef MAESTRO_PROFILE
+        lock_guard<mutex> lock(output_mutex);
+        profile += profile_thread;
+        #endif
+    }
+};
+
+int main(int argc, char **argv){
+    SearchLimits limits;
+    limits.depth = 4;
+    int threads = max(1u, thread::hardware_concurrency());
+    ifstream file;
+    for(int i = 1; i < argc; ++i){
+        const string arg = argv[i];
+        if((arg == "-d") && (i + 1 < argc))
+            limits.depth = atoi(argv[++i]);
+        else if((arg == "-n") && (i + 1 < argc)){
+            limits.nodes = atoll(argv[++i]);
+            limits.depth = 64;
+        }
+        else if((arg == "-t") && (i + 1 < argc))
+            threads = max(1, atoi(argv[++i]));
+        else if(arg == "-s")
+            print_stats = true;
+        else{
+            file.open(arg);
+            if(!file){
+                cerr << "can't open " << arg << '\n';
+                return 1;
+            }
+            input = &file;
+        }
+    }
+
+    // workers are big (move list and board), keep them off the stack
+    vector<unique_ptr<Worker>> workers;
+    for(int i = 0; i < threads; ++i)
+        workers.push_back(make_unique<Worker>());
+
+    vector<thread> pool;
+    for(auto &worker : workers)
+        pool.emplace_back(&Worker::run, worker.get(), limits);
+    for(auto &i : pool)
+        i.join();
+    #ifdef MAESTRO_PROFILE
+    fputs(profile.report().c_str(), stderr);
+    #endif
+}
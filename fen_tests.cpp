@@ -0,0 +1,168 @@
+#include "MainLogic/fenParser.hpp"
+#include "MainLogic/fenView.hpp"
+#include "Board/board.hpp"
+#include "Board/position.hpp"
+#include <string>
+#include <cassert>
+#include <chrono>
+using namespace std;
+using namespace chess;
+
+const string positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbqkbnr/1ppppppp/8/8/pP6/8/P1PPPPPP/RNBQKBNR b KQkq b3 0 2",
+    "rnbqkbnr/ppp1pppp/8/2Pp4/8/8/PP1PPPPP/RNBQKBNR w KQkq d6 0 3",
+    "8/PPP4k/8/8/8/8/ppp4K/8 b - - 37 120"
+};
+
+// the new parser fills both boards exactly like the old ones
+void check_same_as_old(){
+    fenParser parser;
+    for(const string &fen : positions){
+        Board old_brd, new_brd;
+        parser.parse_from_FEN(fen, old_brd);
+        assert(!parse_fen(fen, new_brd));
+        assert(old_brd == new_brd);
+        assert(old_brd.get_fifty_rule() == new_brd.get_fifty_rule());
+        assert(old_brd.get_total_moves() == new_brd.get_total_moves());
+
+        maestro::Board old_bitboards, new_bitboards;
+        old_bitboards.parse_from_FEN(fen);
+        assert(!parse_fen(fen, new_bitboards));
+        assert(old_bitboards == new_bitboards);
+
+        Position pos;
+        assert(!pos.parse_from_FEN(fen));
+        assert(pos.is_consistent());
+        cout << fen << " SUCCESS\n";
+    }
+}
+
+void check_error(const string_view fen, const FenErrorCode code, const int position){
+    FenFields fields;
+    const FenError error = parse_fen(fen, fields);
+    if((error.code != code) || (error.position != position)){
+        cout << "ERRORERRORERROR    " << fen << " expected: " << fen_error_message(code) << " at " << position
+             << " given: " << fen_error_message(error.code) << " at " << error.position << '\n';
+    }
+    assert((error.code == code) && (error.position == position));
+}
+
+void check_errors(){
+    check_error("", Fen_missing_field, 0);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR", Fen_missing_field, 43);
+    check_error("rnbqkbnr/ppppxppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_piece, 13);
+    check_error("rnbqkbnr/ppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_rank, 16);
+    check_error("rnbqkbnr/pppppppp/45/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_rank, 19);
+    check_error("rnbqkbnr/pppppppp/9/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_piece, 18);
+    check_error("rnbqkbnr/pppppppp/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_rank_count, 41);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR/8 w KQkq - 0 1", Fen_bad_rank_count, 43);
+    check_error("rnbqqbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_bad_kings, 0);
+    check_error("rnbqkbnP/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", Fen_pawn_on_last_rank, 7);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR x KQkq - 0 1", Fen_bad_turn, 44);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR wb KQkq - 0 1", Fen_bad_turn, 45);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkx - 0 1", Fen_bad_castling, 49);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KKq - 0 1", Fen_bad_castling, 47);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq e3 0 1", Fen_bad_en_passant, 51);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq i6 0 1", Fen_bad_en_passant, 51);
+    check_error("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0x 1", Fen_bad_number, 54);
+
+    // a rejected FEN does not touch the board
+    Board brd;
+    assert(!parse_fen(positions[1], brd));
+    const Board clone(brd);
+    assert(parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1x", brd));
+    assert(brd == clone);
+    cout << "errors SUCCESS\n";
+}
+
+void check_epd(){
+    // no counters, the operations are handed back untouched
+    FenFields fields;
+    assert(!parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - bm e4; id \"start\";", fields));
+    assert((fields.fifty_moves_rule == 0) && (fields.total_moves == 1));
+    assert(fields.operations == "bm e4; id \"start\";");
+
+    assert(!parse_fen("r3k2r/8/8/8/8/8/8/R3K2R b Kq - 12 40 bm O-O-O;", fields));
+    assert((fields.turn == Black) && (fields.castling == (White_OO | Black_OOO)));
+    assert((fields.fifty_moves_rule == 12) && (fields.total_moves == 40));
+    assert(fields.operations == "bm O-O-O;");
+
+    // the parser is constexpr, so a broken FEN can be caught at compile time
+    static_assert([](){
+        FenFields fields;
+        return !parse_fen("4k3/8/8/8/8/8/8/4K3 w - - 0 1", fields) && (fields.pieces[SQ_E1] == W_King) && (fields.pieces[SQ_E8] == B_King);
+    }());
+    cout << "epd SUCCESS\n";
+}
+
+// parse and write back gives the same text on both boards
+void check_write(){
+    char buffer[fen_buffer_size];
+    fenParser parser;
+    for(const string &fen : positions){
+        Board brd;
+        assert(!parse_fen(fen, brd));
+        assert(string_view(buffer, write_fen(buffer, brd)) == fen);
+        assert(parser.parse_to_Fen(brd) == fen);
+
+        maestro::Board bitboards;
+        assert(!parse_fen(fen, bitboards));
+        assert(string_view(buffer, write_fen(buffer, bitboards)) == fen);
+    }
+
+    // longest ranks and counters still fit
+    Board brd;
+    assert(!parse_fen("rnbqkbnr/pppppppp/PPPPPPPP/PPPPPPPP/pppppppp/pppppppp/PPPPPPPP/RNBQKBNR w KQkq a6 0 1", brd));
+    brd.set_fifty_rule(999'999'999);
+    brd.set_total_moves(999'999'999);
+    assert(write_fen(buffer, brd) - buffer <= fen_buffer_size);
+    cout << "write SUCCESS\n";
+}
+
+void bench(){
+    const int runs = 200'000;
+    fenParser parser;
+    Board brd;
+    int64_t checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i){
+        parser.parse_from_FEN(positions[i % size(positions)], brd);
+        checksum += brd.get_total_moves();
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double old_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i){
+        parse_fen(positions[i % size(positions)], brd);
+        checksum -= brd.get_total_moves();
+    }
+    end = std::chrono::steady_clock::now();
+    const double new_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    assert(checksum == 0);
+    cout << "fenParser: " << old_time / runs << " ns/fen, parse_fen: " << new_time / runs << " ns/fen\n";
+
+    char buffer[fen_buffer_size];
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i){
+        checksum += write_fen(buffer, brd) - buffer;
+    }
+    end = std::chrono::steady_clock::now();
+    cout << "write_fen: " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(runs) << " ns/fen (" << checksum << ")\n";
+}
+
+int main(){
+    check_same_as_old();
+    check_errors();
+    check_epd();
+    check_write();
+    bench();
+}
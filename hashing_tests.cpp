@@ -3,6 +3,9 @@
 #include "Board/board.hpp"
 #include "MainLogic/movegen.hpp"
 #include "ai.hpp"
+#include "MainLogic/fenView.hpp"
+#include "MainLogic/uci.hpp"
+#include "MainLogic/book.hpp"
 #include<fstream>
 #include "tables.hpp"
 #include <bitset>
@@ -41,7 +44,200 @@ struct test_case{
     }
 };
 
+template<Color color>
+Move_full_info find_move(Board &brd, const string &str){
+    Movelist_ref moves(list);
+    Movegen generator(brd, moves);
+    generator.gen_all_moves<color>();
+    for(Move_full_info *i = moves.begin; i != moves.end; ++i){
+        if(move_to_uci(*i) == str)
+            return *i;
+    }
+    return Move_full_info();
+}
+
+// the incremental key follows the full one on every move of the tree
+template<Color color>
+int64_t polyglot_hashtest(Board &brd, int d, Movelist_ref list_ref, u64 hash){
+    assert(hash == polyglot_hash(brd));
+    if(d == 0)
+        return 1;
+    Movegen generator(brd, list_ref);
+    generator.gen_all_moves<color>();
+    int64_t nodes = 0;
+    for(Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+        const u64 new_hash = polyglot_hash<color>(brd, hash, *i);
+        const Accumulator acc = brd.unstable_make_move<color>(*i);
+        nodes += polyglot_hashtest<change_color(color)>(brd, d - 1, list_ref.get_ref(), new_hash);
+        brd.unstable_undo_move<color>(*i, acc);
+    }
+    return nodes;
+}
+
+// keys from the Polyglot book format description
+void check_polyglot(){
+    const pair<string, u64> lines[] = {
+        {"", 0x463b96181691fc9cull},
+        {"e2e4", 0x823c9b50fd114196ull},
+        {"e2e4 d7d5", 0x0756b94461c50fb0ull},
+        {"e2e4 d7d5 e4e5", 0x662fafb965db29d4ull},
+        {"e2e4 d7d5 e4e5 f7f5", 0x22a48b5a8e47ff78ull},
+        {"e2e4 d7d5 e4e5 f7f5 e1e2", 0x652a607ca3f242c1ull},
+        {"e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00fdd303c946bdd9ull},
+        {"a2a4 b7b5 h2h4 b5b4 c2c4", 0x3c8123ea7b067637ull},
+        {"a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5c3f9b829b279560ull}
+    };
+    for(const auto &[line, key] : lines){
+        Board brd;
+        parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", brd);
+        u64 hash = polyglot_hash(brd);
+        istringstream in(line);
+        string str;
+        while(in >> str){
+            if(brd.get_turn()){
+                const Move_full_info move = find_move<White>(brd, str);
+                hash = polyglot_hash<White>(brd, hash, move);
+                brd.unstable_make_move<White>(move);
+            }
+            else{
+                const Move_full_info move = find_move<Black>(brd, str);
+                hash = polyglot_hash<Black>(brd, hash, move);
+                brd.unstable_make_move<Black>(move);
+            }
+        }
+        assert(hash == key);
+        assert(polyglot_hash(brd) == key);
+    }
+
+    const string fens[] = {
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbqkbnr/ppp1pppp/8/2Pp4/8/8/PP1PPPPP/RNBQKBNR w KQkq d6 0 3",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+    };
+    for(const string &fen : fens){
+        Board brd;
+        parse_fen(fen, brd);
+        polyglot_hashtest<White>(brd, 4, Movelist_ref(list), polyglot_hash(brd));
+    }
+    cout << "polyglot keys SUCCESS\n";
+}
+
+// a two position book written by hand, big endian like the real ones
+void check_book(){
+    auto put = [](FILE *file, const u64 key, const u16 move, const u16 weight){
+        const u64 key_be = __builtin_bswap64(key);
+        const u16 move_be = __builtin_bswap16(move), weight_be = __builtin_bswap16(weight);
+        const u32 learn = 0;
+        fwrite(&key_be, 8, 1, file);
+        fwrite(&move_be, 2, 1, file);
+        fwrite(&weight_be, 2, 1, file);
+        fwrite(&learn, 4, 1, file);
+    };
+    auto encode = [](const int from, const int to){ return static_cast<u16>((from << 6) | to); };
+    const char *path = "/tmp/hashing_tests_book.bin";
+    FILE *file = fopen(path, "wb");
+    put(file, 0x0756b94461c50fb0ull, encode(SQ_E4, SQ_D5), 1);
+    put(file, 0x463b96181691fc9cull, encode(SQ_E2, SQ_E4), 30);
+    put(file, 0x463b96181691fc9cull, encode(SQ_D2, SQ_D4), 10);
+    put(file, 0x823c9b50fd114196ull + 1, encode(SQ_A2, SQ_A3), 1);
+    fclose(file);
+
+    PolyglotBook book(path);
+    assert(book.is_open() && (book.size() == 4));
+    Board brd;
+    parse_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", brd);
+    const Board clone(brd);
+    assert(move_to_uci(book.probe(brd, Movelist_ref(list))) == "e2e4");
+    assert(move_to_uci(book.probe(brd, Movelist_ref(list), 35)) == "d2d4");
+    assert(brd == clone);
+
+    parse_fen("rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 2", brd);
+    assert(move_to_uci(book.probe(brd, Movelist_ref(list))) == "e4d5");
+    parse_fen("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", brd);
+    assert(book.probe(brd, Movelist_ref(list)).from_square == No_Square);
+
+    // castling comes as the king taking its rook
+    file = fopen(path, "wb");
+    parse_fen("r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1", brd);
+    put(file, polyglot_hash(brd), encode(SQ_E1, SQ_A1), 1);
+    fclose(file);
+    book.open(path);
+    assert(move_to_uci(book.probe(brd, Movelist_ref(list))) == "e1c1");
+    remove(path);
+    cout << "book SUCCESS\n";
+}
+
+// the cached pawn structure is the computed one, and a repeated structure is a hit
+void check_pawn_hash(){
+    Board brd;
+    parse_fen("4k3/8/8/8/8/8/8/4K3 w - - 0 1", brd);
+    assert(brd.get_pawn_key() == 0);
+
+    // white: doubled and isolated a-pawns, a passed one on the 6th; black: the h-pawn is isolated and passed
+    parse_fen("4k3/8/P6p/8/8/8/P7/4K3 w - - 0 1", brd);
+    const PawnScore score = eval_pawn_structure(brd.get_pawns<White>(), brd.get_pawns<Black>());
+    assert(score.midlegame == doubled_pawn_midlegame + passed_pawn_midlegame[5] + passed_pawn_midlegame[1] - passed_pawn_midlegame[2] +
+                              isolated_pawn_midlegame);
+    assert(score.endgame == doubled_pawn_endgame + passed_pawn_endgame[5] + passed_pawn_endgame[1] - passed_pawn_endgame[2] +
+                            isolated_pawn_endgame);
+
+    PawnHashTable table(16);
+    for(const char *fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                           "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                           "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}){
+        parse_fen(fen, brd);
+        const int uncached = brd.eval_position();
+        assert(brd.eval_position(&table) == uncached);
+        assert(brd.eval_position(&table) == uncached);
+    }
+    assert((table.get_probes() == 6) && (table.get_hits() == 3));
+
+    // a search mostly moves pieces, the structure repeats
+    parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", brd);
+    Movelist_ref list_ref(list);
+    AI bot(brd, list_ref);
+    bot.best_move_ab(4);
+    cout << "pawn hash hit rate " << bot.get_pawn_table().hit_rate() << " over " << bot.get_pawn_table().get_probes() << " probes\n";
+    assert(bot.get_pawn_table().hit_rate() > 0.5);
+    cout << "pawn hash SUCCESS\n";
+}
+
+void check_eval_cache(){
+    EvalCache cache(1);
+    int score = 0;
+    assert(cache.enabled() && !cache.probe(0x1234'5678'9abc'def0, score));
+    cache.store(0x1234'5678'9abc'def0, -321);
+    assert(cache.probe(0x1234'5678'9abc'def0, score) && (score == -321));
+    // the same slot, another key
+    assert(!cache.probe(0x4321'5678'9abc'def0, score));
+    cache.resize(0);
+    assert(!cache.enabled());
+
+    // transpositions hit, the search comes out the same with and without the cache
+    Board brd;
+    parse_fen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", brd);
+    Movelist_ref list_ref(list);
+    AI bot(brd, list_ref);
+    bot.set_eval_cache_size(0);
+    const auto [move, eval] = bot.best_move_ab(4);
+    assert(bot.get_eval_cache_probes() == 0);
+    bot.set_eval_cache_size(4);
+    const auto [cached_move, cached_eval] = bot.best_move_ab(4);
+    assert((move == cached_move) && (eval == cached_eval));
+    cout << "eval cache hit rate " << bot.eval_cache_hit_rate() << " over " << bot.get_eval_cache_probes() << " probes\n";
+    assert(bot.eval_cache_hit_rate() > 0.1);
+    const double cold_rate = bot.eval_cache_hit_rate();
+    bot.best_move_ab(4);
+    assert(bot.eval_cache_hit_rate() > cold_rate);
+    cout << "eval cache SUCCESS\n";
+}
+
 int main(){
+    check_pawn_hash();
+    check_eval_cache();
+    check_polyglot();
+    check_book();
     test_case cases[] = {
         {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
         {"4k3/8/8/pppppppp/PPPPPPPP/8/8/4K3 w - - 0 1", 5},
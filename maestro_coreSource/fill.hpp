@@ -0,0 +1,85 @@
+#pragma once
+#include "types.hpp"
+#include "tables.hpp"
+
+namespace maestro{
+
+    /// Kogge-Stone occluded fill: attacks of all sliders of one side at once,
+    /// no per-piece bitscan loop and no table lookups.
+    ///
+    /// Directions that shift left  (North, East, Northeast, Northwest) and
+    /// directions that shift right (South, West, Southwest, Southeast)
+    /// are filled 4 at a time in one AVX2 register each.
+
+    constexpr u64 not_file_A = ~files[0];
+    constexpr u64 not_file_H = ~files[7];
+
+    template<int step>
+    constexpr u64 shift_by(const u64 mask)noexcept{
+        if constexpr(step > 0){
+            return mask << step;
+        }
+        else{
+            return mask >> -step;
+        }
+    }
+
+    /// @param wrap squares the ray can enter after one step, cuts the wrap around the board edge
+    template<int step, u64 wrap>
+    constexpr u64 occluded_fill_attack(u64 gen, u64 empty)noexcept{
+        empty &= wrap;
+        gen |= empty & shift_by<step>(gen);
+        empty &= shift_by<step>(empty);
+        gen |= empty & shift_by<2 * step>(gen);
+        empty &= shift_by<2 * step>(empty);
+        gen |= empty & shift_by<4 * step>(gen);
+        return shift_by<step>(gen) & wrap;
+    }
+
+    constexpr u64 get_sliders_attack_fill_scalar(const u64 rooks, const u64 bishops, const u64 empty)noexcept{
+        return occluded_fill_attack< 8, ~0ull>(rooks, empty)        | occluded_fill_attack<-8, ~0ull>(rooks, empty)
+             | occluded_fill_attack< 1, not_file_A>(rooks, empty)   | occluded_fill_attack<-1, not_file_H>(rooks, empty)
+             | occluded_fill_attack< 9, not_file_A>(bishops, empty) | occluded_fill_attack< 7, not_file_H>(bishops, empty)
+             | occluded_fill_attack<-7, not_file_A>(bishops, empty) | occluded_fill_attack<-9, not_file_H>(bishops, empty);
+    }
+
+#ifdef __AVX2__
+    /// lanes: North/South, East/West for rooks, Northeast/Southwest, Northwest/Southeast for bishops
+    inline u64 get_sliders_attack_fill(const u64 rooks, const u64 bishops, const u64 empty)noexcept{
+        const __m256i steps      = _mm256_setr_epi64x(8, 1, 9, 7);
+        const __m256i steps_2    = _mm256_setr_epi64x(16, 2, 18, 14);
+        const __m256i steps_4    = _mm256_setr_epi64x(32, 4, 36, 28);
+        const __m256i wrap_left  = _mm256_setr_epi64x(~0ll, static_cast<i64>(not_file_A), static_cast<i64>(not_file_A), static_cast<i64>(not_file_H));
+        const __m256i wrap_right = _mm256_setr_epi64x(~0ll, static_cast<i64>(not_file_H), static_cast<i64>(not_file_H), static_cast<i64>(not_file_A));
+
+        __m256i gen_left = _mm256_setr_epi64x(rooks, rooks, bishops, bishops);
+        __m256i gen_right = gen_left;
+        __m256i empty_left = _mm256_and_si256(_mm256_set1_epi64x(empty), wrap_left);
+        __m256i empty_right = _mm256_and_si256(_mm256_set1_epi64x(empty), wrap_right);
+
+        gen_left    = _mm256_or_si256(gen_left, _mm256_and_si256(empty_left, _mm256_sllv_epi64(gen_left, steps)));
+        gen_right   = _mm256_or_si256(gen_right, _mm256_and_si256(empty_right, _mm256_srlv_epi64(gen_right, steps)));
+        empty_left  = _mm256_and_si256(empty_left, _mm256_sllv_epi64(empty_left, steps));
+        empty_right = _mm256_and_si256(empty_right, _mm256_srlv_epi64(empty_right, steps));
+
+        gen_left    = _mm256_or_si256(gen_left, _mm256_and_si256(empty_left, _mm256_sllv_epi64(gen_left, steps_2)));
+        gen_right   = _mm256_or_si256(gen_right, _mm256_and_si256(empty_right, _mm256_srlv_epi64(gen_right, steps_2)));
+        empty_left  = _mm256_and_si256(empty_left, _mm256_sllv_epi64(empty_left, steps_2));
+        empty_right = _mm256_and_si256(empty_right, _mm256_srlv_epi64(empty_right, steps_2));
+
+        gen_left    = _mm256_or_si256(gen_left, _mm256_and_si256(empty_left, _mm256_sllv_epi64(gen_left, steps_4)));
+        gen_right   = _mm256_or_si256(gen_right, _mm256_and_si256(empty_right, _mm256_srlv_epi64(gen_right, steps_4)));
+
+        const __m256i attacks = _mm256_or_si256(
+            _mm256_and_si256(_mm256_sllv_epi64(gen_left, steps), wrap_left),
+            _mm256_and_si256(_mm256_srlv_epi64(gen_right, steps), wrap_right));
+
+        const __m128i half = _mm_or_si128(_mm256_castsi256_si128(attacks), _mm256_extracti128_si256(attacks, 1));
+        return static_cast<u64>(_mm_cvtsi128_si64(half)) | static_cast<u64>(_mm_extract_epi64(half, 1));
+    }
+#else
+    inline u64 get_sliders_attack_fill(const u64 rooks, const u64 bishops, const u64 empty)noexcept{
+        return get_sliders_attack_fill_scalar(rooks, bishops, empty);
+    }
+#endif
+}
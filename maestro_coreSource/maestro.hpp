@@ -1,6 +1,7 @@
 #pragma once
 #include "types.hpp"
 #include "tables.hpp"
+#include "fill.hpp"
 
 namespace maestro{
         
@@ -49,7 +50,7 @@ namespace maestro{
     
     template<Color clr>
     constexpr Piece promotion_flag_to_piece(const Promotion promotion_flag)noexcept{
-        return type_to_piece<clr, static_cast<PieceType>(static_cast<int>(promotion_flag) + 1)>();
+        return static_cast<Piece>(static_cast<int>(type_to_piece<clr, Type_Knight>()) + static_cast<int>(promotion_flag));
     }
     
     
@@ -365,10 +366,10 @@ namespace maestro{
         template<Color clr>
         inline void do_en_passant_remove(const Square square)noexcept{
             if constexpr(clr){
-                remove_piece<change_color<clr>()>(square - 8, B_Pawn);
+                remove_piece<change_color<clr>()>(static_cast<Square>(square - 8), B_Pawn);
             }
             else{
-                remove_piece<change_color<clr>()>(square + 8, W_Pawn);
+                remove_piece<change_color<clr>()>(static_cast<Square>(square + 8), W_Pawn);
             }
         }
         
@@ -393,26 +394,28 @@ namespace maestro{
         
         template<Color clr>
         inline void do_promotion_put(const Move_full_info move)noexcept{
-            replace_if_present_or_put_piece<clr>(move.to_square, promotion_flag_to_piece<clr>(move.promotion));
+            replace_if_present_or_put_piece<clr>(static_cast<Square>(move.to_square), promotion_flag_to_piece<clr>(static_cast<Promotion>(move.promotion)));
         }
         
         template<Color clr>
         inline void make_move(const Move_full_info move, const Piece piece)noexcept{
             //const Piece piece = mailbox[move.from_square];
-            remove_piece<clr>(move.from_square, piece);
+            const Square from_square = static_cast<Square>(move.from_square);
+            const Square to_square = static_cast<Square>(move.to_square);
+            remove_piece<clr>(from_square, piece);
             switch(move.special){
                 case No_special:
-                    replace_if_present_or_put_piece<clr>(move.to_square, piece);
+                    replace_if_present_or_put_piece<clr>(to_square, piece);
                     break;
                 case SP_Promotion:
                     do_promotion_put<clr>(move);
                     break;
                 case SP_castling:
-                    do_rook_castling<clr>(move.to_square);
+                    do_rook_castling<clr>(to_square);
                     break;
                 case SP_en_passant:
-                    do_en_passant_remove<clr>(move.to_square);
-                    put_piece<clr>(move.to_square, piece);
+                    do_en_passant_remove<clr>(to_square);
+                    put_piece<clr>(to_square, piece);
             }
             Not_free = White_brd | Black_brd;
         }
@@ -421,10 +424,10 @@ namespace maestro{
         template<Color clr>
         inline void undo_en_passant_remove(const Square square){
             if constexpr(clr){
-                put_piece<change_color<clr>()>(square - 8, B_Pawn);
+                put_piece<change_color<clr>()>(static_cast<Square>(square - 8), B_Pawn);
             }
             else{
-                put_piece<change_color<clr>()>(square + 8, W_Pawn);
+                put_piece<change_color<clr>()>(static_cast<Square>(square + 8), W_Pawn);
             }
         }
         
@@ -463,16 +466,18 @@ namespace maestro{
         template<Color clr>
         inline void unmake_move(const Move_full_info move, const Piece piece, const Piece restore_piece)noexcept{
             //const Piece piece = mailbox[move.from_square];
-            remove_piece<clr>(move.to_square);
+            const Square from_square = static_cast<Square>(move.from_square);
+            const Square to_square = static_cast<Square>(move.to_square);
+            remove_piece<clr>(to_square);
             switch(move.special){
                 case SP_en_passant:
-                    undo_en_passant_remove<clr>(move.to_square);
+                    undo_en_passant_remove<clr>(to_square);
                     break;
                 case SP_castling:
-                    undo_castling_rook_move<clr>(move.to_square);
+                    undo_castling_rook_move<clr>(to_square);
             }
-            put_piece<clr>(move.from_square, piece);
-            try_to_restore<clr>(move.to_square, restore_piece);
+            put_piece<clr>(from_square, piece);
+            try_to_restore<clr>(to_square, restore_piece);
             Not_free = White_brd | Black_brd;
         }
         
@@ -555,6 +560,7 @@ namespace maestro{
                 case 'b':
                     who_to_move = Color_Black;
             }
+            ++id;
             while((id < size) && (FEN[id] == ' ')){
                 ++id;
             }
@@ -677,6 +683,9 @@ namespace maestro{
             }
             
 
+            #ifdef MAESTRO_FILL_SLIDERS
+            mask |= gen_sliders_attacked_mask_fill<clr>();
+            #else
             forBits(temp_mask, My_Rooks<clr>() | My_Queens<clr>()){
                 mask |= get_rook_attack_mask(Not_free, bitscan(temp_mask));
             }
@@ -685,9 +694,16 @@ namespace maestro{
             forBits(temp_mask, My_Bishops<clr>() | My_Queens<clr>()){
                 mask |= get_bishop_attack_mask(Not_free, bitscan(temp_mask));
             }
+            #endif
             
             return mask;
         }
+        
+        //all squares attacked by sliders of the Color, one occluded fill instead of a lookup per piece
+        template<Color clr>
+        inline u64 gen_sliders_attacked_mask_fill()noexcept{
+            return get_sliders_attack_fill(My_Rooks<clr>() | My_Queens<clr>(), My_Bishops<clr>() | My_Queens<clr>(), ~Not_free);
+        }
 
         
         template<Color clr>
@@ -0,0 +1,774 @@
+#pragma once
+#include "maestro.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace maestro{
+
+    /// Retrograde win/draw/loss tables for pawnless material (KQvK, KRvKB, KRNvKR ...) up to 5 men.
+    /// Positions are folded by the 8 symmetries of the board: the white king stays in the a1-d1-d4
+    /// triangle, so the two kings take one of 462 pairs and every other piece 6 bits.
+    /// Values are from the side to move, without the 50 move rule.
+
+    enum RetroWDL : u8{
+        RT_Loss = 0,
+        RT_Draw = 1,
+        RT_Win = 2,
+        // only while generating, or no table for a probe
+        RT_Unknown = 3,
+        RT_Invalid = 4
+    };
+
+    constexpr int retro_max_pieces = 5;
+    constexpr int retro_king_pairs = 462;
+
+    /// 4 bits of count per Piece, the same layout as the mailbox engine's tables
+    using RetroMaterial = u64;
+
+    constexpr int retro_material_count(const RetroMaterial key, const Piece piece)noexcept{
+        return (key >> (piece * 4)) & 0xf;
+    }
+
+    constexpr int retro_material_pieces(RetroMaterial key)noexcept{
+        int count = 0;
+        for(; key != 0; key >>= 4)
+            count += key & 0xf;
+        return count;
+    }
+
+    constexpr RetroMaterial retro_swap_material(const RetroMaterial key)noexcept{
+        return ((key & 0xffffffull) << 24) | ((key >> 24) & 0xffffffull);
+    }
+
+    //stronger side is white
+    constexpr bool retro_is_canonical(const RetroMaterial key)noexcept{
+        constexpr int values[] = {1, 3, 3, 5, 9, 0};
+        int white = 0, black = 0;
+        for(int piece = 0; piece < 6; ++piece){
+            white += retro_material_count(key, static_cast<Piece>(piece)) * values[piece];
+            black += retro_material_count(key, static_cast<Piece>(piece + 6)) * values[piece];
+        }
+        if(white != black)
+            return white > black;
+        for(int piece = W_Queen; piece >= W_Pawn; --piece){
+            if(retro_material_count(key, static_cast<Piece>(piece)) != retro_material_count(key, static_cast<Piece>(piece + 6)))
+                return retro_material_count(key, static_cast<Piece>(piece)) > retro_material_count(key, static_cast<Piece>(piece + 6));
+        }
+        return true;
+    }
+
+    //kings first, they make the top of the index, equal pieces stay next to each other
+    constexpr Piece retro_piece_order[] = {W_King, B_King, W_Queen, W_Rook, W_Bishop, W_Knight, B_Queen, B_Rook, B_Bishop, B_Knight};
+
+    inline std::string retro_material_name(const RetroMaterial key){
+        std::string name;
+        for(const Piece piece : {W_King, W_Queen, W_Rook, W_Bishop, W_Knight, W_Pawn, B_King, B_Queen, B_Rook, B_Bishop, B_Knight, B_Pawn}){
+            if(piece == B_King)
+                name += 'v';
+            name.append(retro_material_count(key, piece), "PNBRQK"[piece % 6]);
+        }
+        return name;
+    }
+
+    /// "KRvKB", 0 when it is not pawnless with one king per side
+    inline RetroMaterial retro_material_from_name(const std::string_view name){
+        RetroMaterial key = 0;
+        int side = 0;
+        for(const char symb : name){
+            if(symb == 'v'){
+                if(++side > 1)
+                    return 0;
+                continue;
+            }
+            const char *kind = std::strchr("NBRQK", symb);
+            if((kind == nullptr) || (symb == '\0'))
+                return 0;
+            key += RetroMaterial(1) << (((kind - "NBRQK") + 1 + side * 6) * 4);
+        }
+        if((side != 1) || (retro_material_count(key, W_King) != 1) || (retro_material_count(key, B_King) != 1))
+            return 0;
+        return key;
+    }
+
+    //bit 0 mirrors the files, bit 1 the ranks, bit 2 swaps files and ranks
+    constexpr int retro_transform(int square, const int transform)noexcept{
+        if(transform & 1)
+            square ^= 7;
+        if(transform & 2)
+            square ^= 56;
+        if(transform & 4)
+            square = ((square & 7) << 3) | (square >> 3);
+        return square;
+    }
+
+    constexpr bool in_triangle(const int square)noexcept{
+        return ((square & 7) <= 3) && ((square >> 3) <= (square & 7));
+    }
+
+    constexpr bool on_diagonal(const int square)noexcept{
+        return (square & 7) == (square >> 3);
+    }
+
+    struct RetroKingPairs{
+        std::array<std::array<i16, 64>, 64> index;
+        std::array<std::array<u8, 2>, retro_king_pairs> squares;
+        std::array<u8, 64> triangle_transform;
+    };
+
+    //white king in the triangle, black king on or below the diagonal when the white one is on it
+    consteval RetroKingPairs gen_retro_king_pairs(){
+        RetroKingPairs pairs{};
+        int count = 0;
+        for(int white = 0; white < 64; ++white){
+            for(int black = 0; black < 64; ++black){
+                const bool near = (std::max(std::abs((white & 7) - (black & 7)), std::abs((white >> 3) - (black >> 3))) <= 1);
+                const bool canonical = in_triangle(white) && !near && (!on_diagonal(white) || ((black >> 3) <= (black & 7)));
+                pairs.index[white][black] = -1;
+                if(canonical){
+                    pairs.squares[count] = {static_cast<u8>(white), static_cast<u8>(black)};
+                    pairs.index[white][black] = count++;
+                }
+            }
+            for(int transform = 7; transform >= 0; --transform){
+                if(in_triangle(retro_transform(white, transform)))
+                    pairs.triangle_transform[white] = transform;
+            }
+        }
+        return pairs;
+    }
+
+    constexpr RetroKingPairs retro_king_pairs_table{gen_retro_king_pairs()};
+
+    /// the pieces of a material in index order
+    struct RetroLayout{
+        RetroMaterial material = 0;
+        int count = 0;
+        Piece pieces[retro_max_pieces];
+        size_t entries = 0;
+
+        RetroLayout(){}
+
+        explicit RetroLayout(const RetroMaterial key) : material(key){
+            for(const Piece piece : retro_piece_order){
+                for(int i = 0; (i < retro_material_count(key, piece)) && (count < retro_max_pieces); ++i)
+                    pieces[count++] = piece;
+            }
+            entries = size_t(2 * retro_king_pairs) << (6 * (count - 2));
+        }
+
+        //equal pieces sorted, compares the squares after the kings
+        inline void sort_equal(Square *squares)const noexcept{
+            for(int i = 3; i < count; ++i){
+                for(int j = i; (j > 2) && (pieces[j] == pieces[j - 1]) && (squares[j] < squares[j - 1]); --j)
+                    std::swap(squares[j], squares[j - 1]);
+            }
+        }
+
+        /// folds the squares to their canonical placement, SIZE_MAX for kings next to each other
+        inline size_t index(Square *squares, const Color turn)const noexcept{
+            const int transform = retro_king_pairs_table.triangle_transform[squares[0]];
+            for(int i = 0; i < count; ++i)
+                squares[i] = static_cast<Square>(retro_transform(squares[i], transform));
+            if(on_diagonal(squares[0])){
+                bool transpose = (squares[1] >> 3) > (squares[1] & 7);
+                if(on_diagonal(squares[1])){
+                    //both kings on the diagonal, the mirror with the lower squares is kept
+                    Square mirrored[retro_max_pieces];
+                    for(int i = 0; i < count; ++i)
+                        mirrored[i] = static_cast<Square>(retro_transform(squares[i], 4));
+                    sort_equal(squares);
+                    sort_equal(mirrored);
+                    transpose = std::lexicographical_compare(mirrored + 2, mirrored + count, squares + 2, squares + count);
+                }
+                if(transpose){
+                    for(int i = 0; i < count; ++i)
+                        squares[i] = static_cast<Square>(retro_transform(squares[i], 4));
+                }
+            }
+            sort_equal(squares);
+            const int pair = retro_king_pairs_table.index[squares[0]][squares[1]];
+            if(pair < 0)
+                return SIZE_MAX;
+            size_t id = (turn ? 0 : retro_king_pairs) + pair;
+            for(int i = 2; i < count; ++i)
+                id = (id << 6) | squares[i];
+            return id;
+        }
+
+        /// the squares and the side to move of an index, false when it is not a canonical placement
+        inline bool decode(const size_t id, Square *squares, Color &turn)const noexcept{
+            size_t rest = id;
+            for(int i = count - 1; i >= 2; --i){
+                squares[i] = static_cast<Square>(rest & 63);
+                rest >>= 6;
+            }
+            turn = static_cast<Color>(rest < retro_king_pairs);
+            squares[0] = static_cast<Square>(retro_king_pairs_table.squares[rest % retro_king_pairs][0]);
+            squares[1] = static_cast<Square>(retro_king_pairs_table.squares[rest % retro_king_pairs][1]);
+            u64 occupied = 0;
+            for(int i = 0; i < count; ++i){
+                if(occupied & bit_at(squares[i]))
+                    return false;
+                occupied |= bit_at(squares[i]);
+            }
+            Square folded[retro_max_pieces];
+            std::copy(squares, squares + count, folded);
+            return index(folded, turn) == id;
+        }
+    };
+
+    inline u64 retro_attacks(const Piece piece, const int square, const u64 occupied)noexcept{
+        switch(piece % 6){
+            case W_Knight:
+                return knights_moves[square];
+            case W_Bishop:
+                return get_bishop_attack_mask(occupied, square);
+            case W_Rook:
+                return get_rook_attack_mask(occupied, square);
+            case W_Queen:
+                return get_queen_attack(occupied, square);
+            default:
+                return king_moves[square];
+        }
+    }
+
+    /// On disk: the header, block_count + 1 offsets into the data, then the blocks.
+    /// Values are packed 5 to a byte in base 3, a block is 2048 such bytes stored raw or run length coded,
+    /// so any index is read by one offset lookup and a walk inside its block.
+    struct RetroHeader{
+        char magic[4];
+        u8 piece_count;
+        u8 reserved[3];
+        u32 block_count;
+        u32 block_entries;
+        u64 material;
+        u64 entries;
+    };
+
+    static_assert(sizeof(RetroHeader) == 32);
+
+    constexpr char retro_magic[4] = {'M', 'W', 'D', 'L'};
+    constexpr u32 retro_block_bytes = 2048;
+    constexpr u32 retro_block_entries = retro_block_bytes * 5;
+
+    enum RetroBlock : u8{
+        RB_Raw = 0,
+        RB_Runs = 1
+    };
+
+    constexpr u8 retro_pow3[5] = {1, 3, 9, 27, 81};
+
+    /// the file image of a generated table, invalid entries take the value before them so the runs grow
+    inline std::vector<u8> retro_compress(const RetroLayout &layout, const std::vector<u8> &values){
+        const u32 block_count = (layout.entries + retro_block_entries - 1) / retro_block_entries;
+        std::vector<u8> image(sizeof(RetroHeader) + 4 * (block_count + 1));
+        RetroHeader header{};
+        std::memcpy(header.magic, retro_magic, 4);
+        header.piece_count = layout.count;
+        header.block_count = block_count;
+        header.block_entries = retro_block_entries;
+        header.material = layout.material;
+        header.entries = layout.entries;
+        std::memcpy(image.data(), &header, sizeof(header));
+
+        const size_t data_start = image.size();
+        u8 last = RT_Draw;
+        std::vector<u8> packed, runs;
+        for(u32 block = 0; block < block_count; ++block){
+            const u32 offset = image.size() - data_start;
+            std::memcpy(image.data() + sizeof(RetroHeader) + 4 * block, &offset, 4);
+
+            packed.clear();
+            const size_t begin = size_t(block) * retro_block_entries, end = std::min<size_t>(begin + retro_block_entries, layout.entries);
+            for(size_t id = begin; id < end; id += 5){
+                u8 byte = 0;
+                for(size_t digit = 0; (digit < 5) && (id + digit < end); ++digit){
+                    if(values[id + digit] <= RT_Win)
+                        last = values[id + digit];
+                    byte += last * retro_pow3[digit];
+                }
+                packed.push_back(byte);
+            }
+
+            runs.clear();
+            for(size_t i = 0; i < packed.size();){
+                size_t length = 1;
+                while((i + length < packed.size()) && (packed[i + length] == packed[i]) && (length < 255))
+                    ++length;
+                runs.push_back(length);
+                runs.push_back(packed[i]);
+                i += length;
+            }
+            const bool use_runs = runs.size() < packed.size();
+            image.push_back(use_runs ? RB_Runs : RB_Raw);
+            const std::vector<u8> &block_data = use_runs ? runs : packed;
+            image.insert(image.end(), block_data.begin(), block_data.end());
+        }
+        const u32 offset = image.size() - data_start;
+        std::memcpy(image.data() + sizeof(RetroHeader) + 4 * block_count, &offset, 4);
+        return image;
+    }
+
+    /// a compressed table mapped read-only
+    class RetroFile{
+    private:
+        void *mapped = nullptr;
+        size_t mapped_size = 0;
+        const RetroHeader *header = nullptr;
+        const u8 *data = nullptr;
+        RetroLayout layout;
+
+        inline u32 offset(const u32 block)const noexcept{
+            u32 value;
+            std::memcpy(&value, reinterpret_cast<const u8*>(header + 1) + 4 * block, 4);
+            return value;
+        }
+
+    public:
+        RetroFile(){}
+        RetroFile(const RetroFile&) = delete;
+        RetroFile& operator=(const RetroFile&) = delete;
+
+        ~RetroFile(){
+            if(mapped != nullptr)
+                munmap(mapped, mapped_size);
+        }
+
+        bool load(const char *path){
+            const int fd = open(path, O_RDONLY);
+            if(fd < 0)
+                return false;
+            struct stat info;
+            if((fstat(fd, &info) == 0) && (info.st_size >= static_cast<off_t>(sizeof(RetroHeader)))){
+                void *ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(ptr != MAP_FAILED){
+                    mapped = ptr;
+                    mapped_size = info.st_size;
+                    header = static_cast<const RetroHeader*>(ptr);
+                    layout = RetroLayout(header->material);
+                    const size_t table_end = sizeof(RetroHeader) + 4 * (size_t(header->block_count) + 1);
+                    if((std::memcmp(header->magic, retro_magic, 4) != 0) || (header->piece_count > retro_max_pieces) ||
+                       (header->piece_count != retro_material_pieces(header->material)) || (layout.entries != header->entries) ||
+                       (header->block_entries != retro_block_entries) || (mapped_size < table_end) ||
+                       (header->block_count != (header->entries + retro_block_entries - 1) / retro_block_entries) ||
+                       (mapped_size - table_end < offset(header->block_count)))
+                        header = nullptr;
+                    else
+                        data = static_cast<const u8*>(ptr) + table_end;
+                }
+            }
+            close(fd);
+            return is_open();
+        }
+
+        inline bool is_open()const noexcept{ return header != nullptr; }
+        inline RetroMaterial get_material()const noexcept{ return header->material; }
+        inline size_t size()const noexcept{ return mapped_size; }
+        inline const RetroLayout& get_layout()const noexcept{ return layout; }
+
+        /// RetroWDL of an index, values of invalid placements are whatever the packing left there
+        inline int entry(const size_t id)const noexcept{
+            const u32 block = id / retro_block_entries;
+            const u32 byte_id = (id % retro_block_entries) / 5;
+            const u8 *block_data = data + offset(block);
+            u8 byte;
+            if(block_data[0] == RB_Raw)
+                byte = block_data[1 + byte_id];
+            else{
+                const u8 *run = block_data + 1;
+                for(u32 skipped = run[0]; skipped <= byte_id; skipped += run[0])
+                    run += 2;
+                byte = run[1];
+            }
+            return (byte / retro_pow3[id % 5]) % 3;
+        }
+
+        /// positions with castling rights or an en passant square are not in the table
+        int probe(const Board &brd)const noexcept{
+            if((brd.castle_rights != NO_Castling) || (brd.en_passant_take_square != No_Square) || (std::popcount(brd.Not_free) != layout.count))
+                return RT_Invalid;
+            RetroMaterial key = 0;
+            forBits(mask, brd.Not_free)
+                key += RetroMaterial(1) << (brd.mailbox[bitscan(mask)] * 4);
+            const bool swapped = key != layout.material;
+            if(swapped && (retro_swap_material(key) != layout.material))
+                return RT_Invalid;
+
+            Square squares[retro_max_pieces];
+            bool used[retro_max_pieces] = {};
+            forBits(mask, brd.Not_free){
+                const int square = bitscan(mask);
+                const Piece piece = swapped ? static_cast<Piece>((brd.mailbox[square] + 6) % 12) : brd.mailbox[square];
+                for(int slot = 0; slot < layout.count; ++slot){
+                    if(!used[slot] && (layout.pieces[slot] == piece)){
+                        used[slot] = true;
+                        squares[slot] = static_cast<Square>(swapped ? (square ^ 56) : square);
+                        break;
+                    }
+                }
+            }
+            const size_t id = layout.index(squares, static_cast<Color>(swapped != static_cast<bool>(brd.who_to_move)));
+            return (id == SIZE_MAX) ? static_cast<int>(RT_Invalid) : entry(id);
+        }
+    };
+
+    /// statistics of one generated material
+    struct RetroStats{
+        RetroMaterial material;
+        size_t entries;
+        size_t wins, draws, losses;
+        int64_t milliseconds;
+        size_t raw_bytes;
+        size_t file_bytes;
+    };
+
+    /// Retrograde analysis over the bitboards: mates are the first losses, every position that can move
+    /// into a loss is a win, every position whose moves all reach wins is a loss, until nothing is added.
+    /// Captures leave the table, so the smaller tables are generated first and read directly.
+    class RetroGenerator{
+    private:
+        int threads;
+        std::map<RetroMaterial, std::vector<u8>> tables;
+        std::vector<RetroStats> stats;
+
+        //one per thread, the board only ever holds the pieces of the current table
+        struct Worker{
+            const RetroGenerator &generator;
+            const RetroLayout &layout;
+            u8 *values;
+            Board brd;
+            Square squares[retro_max_pieces];
+            Color turn;
+            // the first pass only knows the smaller tables
+            bool first_pass = false;
+
+            Worker(const RetroGenerator &gen, const RetroLayout &lay, u8 *vals) : generator(gen), layout(lay), values(vals){
+                brd.clear_boards();
+                brd.who_to_move = Color_White;
+            }
+
+            inline u8 load(const size_t id)const noexcept{
+                return std::atomic_ref<u8>(values[id]).load(std::memory_order_relaxed);
+            }
+
+            inline bool resolve(const size_t id, const u8 value)noexcept{
+                u8 expected = RT_Unknown;
+                return std::atomic_ref<u8>(values[id]).compare_exchange_strong(expected, value, std::memory_order_relaxed);
+            }
+
+            inline void clear()noexcept{
+                for(int i = 0; i < layout.count; ++i){
+                    if(brd.mailbox[squares[i]] == layout.pieces[i])
+                        layout.pieces[i] < 6 ? brd.remove_piece<Color_White>(squares[i]) : brd.remove_piece<Color_Black>(squares[i]);
+                }
+                brd.Not_free = brd.White_brd | brd.Black_brd;
+            }
+
+            template<Color clr>
+            inline bool king_attacked()noexcept{
+                return (brd.gen_attacked_mask_by_Color<change_color<clr>()>() & brd.My_King<clr>()) != 0;
+            }
+
+            /// false for an index that is no position, the side not to move may not be in check
+            bool setup(const size_t id)noexcept{
+                if(!layout.decode(id, squares, turn))
+                    return false;
+                for(int i = 0; i < layout.count; ++i)
+                    layout.pieces[i] < 6 ? brd.put_piece<Color_White>(squares[i], layout.pieces[i]) : brd.put_piece<Color_Black>(squares[i], layout.pieces[i]);
+                brd.Not_free = brd.White_brd | brd.Black_brd;
+                brd.who_to_move = turn;
+                return turn ? !king_attacked<Color_Black>() : !king_attacked<Color_White>();
+            }
+
+            /// value of the position after the move for the side that is then to move
+            template<Color clr>
+            u8 child_value(const int slot, const Square to, const Piece captured)noexcept{
+                Piece pieces[retro_max_pieces];
+                Square child[retro_max_pieces];
+                int count = 0;
+                for(int i = 0; i < layout.count; ++i){
+                    if(captured != No_Piece && squares[i] == to)
+                        continue;
+                    pieces[count] = layout.pieces[i];
+                    child[count++] = (i == slot) ? to : squares[i];
+                }
+                if(captured == No_Piece)
+                    return first_pass ? static_cast<u8>(RT_Unknown) : load(layout.index(child, change_color<clr>()));
+                return generator.probe(pieces, child, count, change_color<clr>());
+            }
+
+            /// calls visit(value) for every legal move of the side to move, stops when it returns false
+            template<Color clr, class Visit>
+            void for_each_move(Visit &&visit)noexcept{
+                for(int slot = 0; slot < layout.count; ++slot){
+                    const Piece piece = layout.pieces[slot];
+                    if((piece < 6) != static_cast<bool>(clr))
+                        continue;
+                    const Square from = squares[slot];
+                    forBits(mask, retro_attacks(piece, from, brd.Not_free) & ~brd.My_Board<clr>()){
+                        const Square to = static_cast<Square>(bitscan(mask));
+                        const Piece captured = brd.mailbox[to];
+                        brd.remove_piece<clr>(from, piece);
+                        if(captured != No_Piece)
+                            brd.remove_piece<change_color<clr>()>(to, captured);
+                        brd.put_piece<clr>(to, piece);
+                        brd.Not_free = brd.White_brd | brd.Black_brd;
+                        const bool legal = !king_attacked<clr>();
+                        brd.remove_piece<clr>(to, piece);
+                        if(captured != No_Piece)
+                            brd.put_piece<change_color<clr>()>(to, captured);
+                        brd.put_piece<clr>(from, piece);
+                        brd.Not_free = brd.White_brd | brd.Black_brd;
+                        if(legal && !visit(child_value<clr>(slot, to, captured)))
+                            return;
+                    }
+                }
+            }
+
+            /// the indices the side that just moved came from, without captures
+            template<Color mover>
+            void unmoves(std::vector<u32> &out)noexcept{
+                for(int slot = 0; slot < layout.count; ++slot){
+                    const Piece piece = layout.pieces[slot];
+                    if((piece < 6) != static_cast<bool>(mover))
+                        continue;
+                    const Square to = squares[slot];
+                    forBits(mask, retro_attacks(piece, to, brd.Not_free) & ~brd.Not_free){
+                        const Square from = static_cast<Square>(bitscan(mask));
+                        brd.remove_piece<mover>(to, piece);
+                        brd.put_piece<mover>(from, piece);
+                        brd.Not_free = brd.White_brd | brd.Black_brd;
+                        const bool valid = !king_attacked<change_color<mover>()>();
+                        brd.remove_piece<mover>(from, piece);
+                        brd.put_piece<mover>(to, piece);
+                        brd.Not_free = brd.White_brd | brd.Black_brd;
+                        if(!valid)
+                            continue;
+                        Square parent[retro_max_pieces];
+                        std::copy(squares, squares + layout.count, parent);
+                        parent[slot] = from;
+                        out.push_back(layout.index(parent, mover));
+                    }
+                }
+            }
+
+            template<Color clr>
+            u8 first_value(bool &in_check)noexcept{
+                in_check = king_attacked<clr>();
+                bool any_move = false, all_known_wins = true, capture_wins = false;
+                for_each_move<clr>([&](const u8 value){
+                    any_move = true;
+                    capture_wins |= value == RT_Loss;
+                    all_known_wins &= value == RT_Win;
+                    return !capture_wins;
+                });
+                if(!any_move)
+                    return in_check ? RT_Loss : RT_Draw;
+                if(capture_wins)
+                    return RT_Win;
+                return all_known_wins ? RT_Loss : RT_Unknown;
+            }
+
+            template<Color clr>
+            bool all_moves_win()noexcept{
+                bool all_win = true;
+                for_each_move<clr>([&](const u8 value){
+                    all_win &= value == RT_Win;
+                    return all_win;
+                });
+                return all_win;
+            }
+        };
+
+        // splits [0, count) in chunks over the threads, work(worker, id, thread)
+        template<class Work>
+        void run_parallel(const RetroLayout &layout, u8 *values, const size_t count, const Work &work){
+            std::atomic<size_t> next{0};
+            constexpr size_t chunk = 4096;
+            std::vector<std::thread> pool;
+            for(int thread = 0; thread < threads; ++thread){
+                pool.emplace_back([&, thread](){
+                    Worker worker(*this, layout, values);
+                    for(size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk)){
+                        for(size_t id = begin; id < std::min(begin + chunk, count); ++id)
+                            work(worker, id, thread);
+                    }
+                });
+            }
+            for(std::thread &thread : pool)
+                thread.join();
+        }
+
+        static std::vector<u32> merge(std::vector<std::vector<u32>> &parts){
+            std::vector<u32> all;
+            for(std::vector<u32> &part : parts){
+                all.insert(all.end(), part.begin(), part.end());
+                part.clear();
+            }
+            return all;
+        }
+
+        std::vector<u8> build(const RetroLayout &layout){
+            std::vector<u8> values(layout.entries, RT_Unknown);
+            std::vector<std::vector<u32>> new_losses(threads), new_wins(threads), parents(threads);
+
+            run_parallel(layout, values.data(), layout.entries, [&](Worker &worker, const size_t id, const int thread){
+                worker.first_pass = true;
+                if(!worker.setup(id)){
+                    worker.clear();
+                    values[id] = RT_Invalid;
+                    return;
+                }
+                bool in_check;
+                const u8 value = worker.turn ? worker.template first_value<Color_White>(in_check) : worker.template first_value<Color_Black>(in_check);
+                worker.clear();
+                values[id] = value;
+                if(value == RT_Loss)
+                    new_losses[thread].push_back(id);
+                else if(value == RT_Win)
+                    new_wins[thread].push_back(id);
+            });
+            std::vector<u32> losses = merge(new_losses), wins = merge(new_wins);
+
+            while(!losses.empty() || !wins.empty()){
+                // whoever can move into a loss wins
+                run_parallel(layout, values.data(), losses.size(), [&](Worker &worker, const size_t id, const int thread){
+                    std::vector<u32> &parent = parents[thread];
+                    parent.clear();
+                    worker.setup(losses[id]);
+                    worker.turn ? worker.template unmoves<Color_Black>(parent) : worker.template unmoves<Color_White>(parent);
+                    worker.clear();
+                    for(const u32 parent_id : parent){
+                        if(worker.resolve(parent_id, RT_Win))
+                            new_wins[thread].push_back(parent_id);
+                    }
+                });
+                const std::vector<u32> found_wins = merge(new_wins);
+                wins.insert(wins.end(), found_wins.begin(), found_wins.end());
+
+                // whoever only moves into wins loses, checked by moving forward
+                run_parallel(layout, values.data(), wins.size(), [&](Worker &worker, const size_t id, const int thread){
+                    std::vector<u32> &parent = parents[thread];
+                    parent.clear();
+                    worker.setup(wins[id]);
+                    worker.turn ? worker.template unmoves<Color_Black>(parent) : worker.template unmoves<Color_White>(parent);
+                    worker.clear();
+                    for(const u32 parent_id : parent){
+                        if(worker.load(parent_id) != RT_Unknown)
+                            continue;
+                        worker.setup(parent_id);
+                        const bool lost = worker.turn ? worker.template all_moves_win<Color_White>() : worker.template all_moves_win<Color_Black>();
+                        worker.clear();
+                        if(lost && worker.resolve(parent_id, RT_Loss))
+                            new_losses[thread].push_back(parent_id);
+                    }
+                });
+                losses = merge(new_losses);
+                wins.clear();
+            }
+
+            // nothing forces a result
+            for(u8 &value : values){
+                if(value == RT_Unknown)
+                    value = RT_Draw;
+            }
+            return values;
+        }
+
+    public:
+        explicit RetroGenerator(const int thread_count = std::thread::hardware_concurrency()) : threads(std::max(1, thread_count)){}
+
+        /// RetroWDL of a position of a generated material, either color may be the stronger one
+        u8 probe(const Piece *pieces, const Square *squares, const int count, const Color turn)const noexcept{
+            RetroMaterial key = 0;
+            for(int i = 0; i < count; ++i)
+                key += RetroMaterial(1) << (pieces[i] * 4);
+            const bool swapped = !retro_is_canonical(key);
+            const auto table = tables.find(swapped ? retro_swap_material(key) : key);
+            if(table == tables.end())
+                return RT_Invalid;
+            const RetroLayout layout(table->first);
+            Square placed[retro_max_pieces];
+            bool used[retro_max_pieces] = {};
+            for(int i = 0; i < count; ++i){
+                const Piece piece = swapped ? static_cast<Piece>((pieces[i] + 6) % 12) : pieces[i];
+                for(int slot = 0; slot < count; ++slot){
+                    if(!used[slot] && (layout.pieces[slot] == piece)){
+                        used[slot] = true;
+                        placed[slot] = static_cast<Square>(swapped ? (squares[i] ^ 56) : squares[i]);
+                        break;
+                    }
+                }
+            }
+            const size_t id = layout.index(placed, static_cast<Color>(swapped != static_cast<bool>(turn)));
+            return (id == SIZE_MAX) ? static_cast<u8>(RT_Invalid) : table->second[id];
+        }
+
+        /// generates the material and everything a capture turns it into, false when it is not supported
+        bool generate(RetroMaterial key){
+            if(!retro_is_canonical(key))
+                key = retro_swap_material(key);
+            if(tables.count(key) != 0)
+                return true;
+            if((retro_material_pieces(key) > retro_max_pieces) || (retro_material_count(key, W_Pawn) != 0) || (retro_material_count(key, B_Pawn) != 0) ||
+               (retro_material_count(key, W_King) != 1) || (retro_material_count(key, B_King) != 1))
+                return false;
+            for(const Piece piece : retro_piece_order){
+                if((piece != W_King) && (piece != B_King) && (retro_material_count(key, piece) != 0) && !generate(key - (RetroMaterial(1) << (piece * 4))))
+                    return false;
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            const RetroLayout layout(key);
+            std::vector<u8> values = build(layout);
+            const int64_t milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+            RetroStats stat{key, layout.entries, 0, 0, 0, milliseconds, layout.entries, retro_compress(layout, values).size()};
+            for(const u8 value : values){
+                stat.wins += value == RT_Win;
+                stat.draws += value == RT_Draw;
+                stat.losses += value == RT_Loss;
+            }
+            stats.push_back(stat);
+            tables.emplace(key, std::move(values));
+            return true;
+        }
+
+        bool generate(const std::string_view name){
+            const RetroMaterial key = retro_material_from_name(name);
+            return (key != 0) && generate(key);
+        }
+
+        /// raw values by index, RT_Invalid for indices that are no position
+        const std::vector<u8>* find(const RetroMaterial key)const{
+            const auto table = tables.find(key);
+            return (table == tables.end()) ? nullptr : &table->second;
+        }
+
+        bool save(const RetroMaterial key, const char *path)const{
+            const std::vector<u8> *values = find(key);
+            if(values == nullptr)
+                return false;
+            const std::vector<u8> image = retro_compress(RetroLayout(key), *values);
+            FILE *file = fopen(path, "wb");
+            if(file == nullptr)
+                return false;
+            const bool written = fwrite(image.data(), 1, image.size(), file) == image.size();
+            return (fclose(file) == 0) && written;
+        }
+
+        /// one entry per generated material, in generation order
+        inline const std::vector<RetroStats>& get_stats()const noexcept{ return stats; }
+    };
+}
@@ -0,0 +1,210 @@
+#include "retro.hpp"
+#include "../MainLogic/tbgen.hpp"
+#include <cassert>
+#include <cstdio>
+
+using namespace std;
+using namespace maestro;
+
+chess::Movelist<512> list;
+
+chess::Board to_mailbox(const RetroLayout &layout, const Square *squares, const Color turn){
+    chess::Board brd;
+    brd.clear_board();
+    brd.set_castling(chess::NO_Castling);
+    brd.set_en_passant(chess::No_Square);
+    brd.set_turn(static_cast<chess::Color>(static_cast<bool>(turn)));
+    for(int i = 0; i < layout.count; ++i)
+        brd.set_piece(squares[i], static_cast<chess::Piece>(layout.pieces[i]));
+    brd.find_kings();
+    return brd;
+}
+
+int to_retro(const int wdl){
+    return (wdl == chess::TB_Win) ? RT_Win : (wdl == chess::TB_Loss) ? RT_Loss : RT_Draw;
+}
+
+void check_king_pairs(){
+    int pairs = 0;
+    for(int white = 0; white < 64; ++white){
+        for(int black = 0; black < 64; ++black)
+            pairs += retro_king_pairs_table.index[white][black] >= 0;
+    }
+    assert(pairs == retro_king_pairs);
+
+    // every symmetric image of a position folds to the same index
+    const RetroLayout layout(retro_material_from_name("KRRvKN"));
+    const Square position[] = {SQ_F6, SQ_C2, SQ_H1, SQ_A8, SQ_D5};
+    Square folded[retro_max_pieces];
+    copy(begin(position), end(position), folded);
+    const size_t id = layout.index(folded, Color_White);
+    for(int transform = 0; transform < 8; ++transform){
+        Square image[retro_max_pieces];
+        for(int i = 0; i < layout.count; ++i)
+            image[i] = static_cast<Square>(retro_transform(position[i], transform));
+        swap(image[2], image[3]);
+        assert(layout.index(image, Color_White) == id);
+    }
+    cout << "king pairs SUCCESS\n";
+}
+
+// the same results as the mailbox generator, which walks every move forward
+void check_against_mailbox(const RetroGenerator &generator, const chess::Tablebases &tablebases, const char *name){
+    const RetroLayout layout(retro_material_from_name(name));
+    const vector<u8> &values = *generator.find(layout.material);
+    size_t compared = 0;
+    for(size_t id = 0; id < layout.entries; ++id){
+        Square squares[retro_max_pieces];
+        Color turn;
+        if(!layout.decode(id, squares, turn)){
+            assert(values[id] == RT_Invalid);
+            continue;
+        }
+        const chess::TbProbe probe = tablebases.probe(to_mailbox(layout, squares, turn));
+        assert(probe.found == (values[id] != RT_Invalid));
+        if(probe.found){
+            assert(to_retro(probe.wdl) == values[id]);
+            ++compared;
+        }
+    }
+    cout << name << ": " << compared << " positions SUCCESS\n";
+}
+
+// every stride-th position agrees with one ply of the mailbox move generator over the tables
+void check_one_ply(const RetroGenerator &generator, const char *name, const size_t stride){
+    const RetroLayout layout(retro_material_from_name(name));
+    const vector<u8> &values = *generator.find(layout.material);
+    size_t compared = 0;
+    for(size_t id = 0; id < layout.entries; id += stride){
+        if(values[id] == RT_Invalid)
+            continue;
+        Square squares[retro_max_pieces];
+        Color turn;
+        assert(layout.decode(id, squares, turn));
+        chess::Board brd = to_mailbox(layout, squares, turn);
+
+        chess::Movelist_ref list_ref(list);
+        chess::Movegen movegen(brd, list_ref);
+        const chess::PositionState state = brd.get_turn() ? movegen.gen_all_moves<chess::White>() : movegen.gen_all_moves<chess::Black>();
+        int best = list_ref.no_moves() ? ((state >= chess::check) ? RT_Loss : RT_Draw) : RT_Loss;
+        for(chess::Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+            const chess::Accumulator acc = brd.get_turn() ? brd.unstable_make_move<chess::White>(*i) : brd.unstable_make_move<chess::Black>(*i);
+            Piece pieces[retro_max_pieces];
+            Square child[retro_max_pieces];
+            int count = 0;
+            for(int square = 0; square < 64; ++square){
+                if(brd[square] != chess::No_Piece){
+                    pieces[count] = static_cast<Piece>(brd[square]);
+                    child[count++] = static_cast<Square>(square);
+                }
+            }
+            const u8 value = generator.probe(pieces, child, count, static_cast<Color>(static_cast<bool>(brd.get_turn())));
+            brd.get_turn() ? brd.unstable_undo_move<chess::Black>(*i, acc) : brd.unstable_undo_move<chess::White>(*i, acc);
+            assert(value <= RT_Win);
+            best = max(best, RT_Win - value);
+        }
+        assert(best == values[id]);
+        ++compared;
+    }
+    cout << name << ": " << compared << " positions one ply SUCCESS\n";
+}
+
+void check_file(const RetroGenerator &generator, const char *name){
+    const RetroMaterial key = retro_material_from_name(name);
+    const char *path = "/tmp/retro_tests.mwdl";
+    assert(generator.save(key, path));
+    RetroFile file;
+    assert(file.load(path) && (file.get_material() == key));
+    const vector<u8> &values = *generator.find(key);
+    for(size_t id = 0; id < values.size(); ++id){
+        if(values[id] != RT_Invalid)
+            assert(file.entry(id) == values[id]);
+    }
+    remove(path);
+    RetroFile missing;
+    assert(!missing.load("/tmp/retro_tests_missing.mwdl"));
+    cout << name << " file SUCCESS\n";
+}
+
+// the MWDL files against the MTB1 files tbgen writes for the same material, entry by entry
+void check_against_mtb(const RetroGenerator &generator, const chess::Tablebases &tablebases, const char *name){
+    const RetroLayout layout(retro_material_from_name(name));
+    const char *mwdl_path = "/tmp/retro_tests_cross.mwdl", *mtb_path = "/tmp/retro_tests_cross.mtb";
+    assert(generator.save(layout.material, mwdl_path));
+    const chess::TbTable *table = tablebases.find(chess::material_from_name(name));
+    assert((table != nullptr) && table->save(mtb_path));
+    RetroFile file;
+    assert(file.load(mwdl_path));
+    chess::Tablebases from_file;
+    assert(from_file.load(mtb_path));
+    size_t compared = 0;
+    for(size_t id = 0; id < layout.entries; ++id){
+        Square squares[retro_max_pieces];
+        Color turn;
+        if(!layout.decode(id, squares, turn))
+            continue;
+        const chess::TbProbe probe = from_file.probe(to_mailbox(layout, squares, turn));
+        // the file keeps no invalid marks, it fills them in for compression
+        if(!probe.found)
+            continue;
+        assert(to_retro(probe.wdl) == file.entry(id));
+        ++compared;
+    }
+    remove(mwdl_path);
+    remove(mtb_path);
+    cout << name << ": " << compared << " positions against MTB1 SUCCESS\n";
+}
+
+void check_probe(const RetroGenerator &generator){
+    const char *path = "/tmp/retro_tests_KQvK.mwdl";
+    assert(generator.save(retro_material_from_name("KQvK"), path));
+    RetroFile file;
+    assert(file.load(path));
+    Board brd;
+    brd.parse_from_FEN("k7/8/1K6/8/8/8/7Q/8 w - - 0 1");
+    assert(file.probe(brd) == RT_Win);
+    brd.parse_from_FEN("k7/1Q6/1K6/8/8/8/8/8 b - - 0 1");
+    assert(file.probe(brd) == RT_Loss);
+    // colors exchanged
+    brd.parse_from_FEN("8/7q/8/8/8/1k6/8/K7 b - - 0 1");
+    assert(file.probe(brd) == RT_Win);
+    brd.parse_from_FEN("8/8/8/8/8/1k6/8/K7 b - - 0 1");
+    assert(file.probe(brd) == RT_Invalid);
+    brd.parse_from_FEN("k7/8/1K6/8/8/8/7Q/8 w - - 0 1");
+    brd.en_passant_take_square = SQ_E3;
+    assert(file.probe(brd) == RT_Invalid);
+    remove(path);
+    cout << "probe SUCCESS\n";
+}
+
+void print_stats(const RetroGenerator &generator){
+    printf("%-8s %10s %10s %10s %10s %8s %10s %10s\n", "material", "entries", "wins", "draws", "losses", "ms", "raw", "file");
+    for(const RetroStats &stats : generator.get_stats()){
+        printf("%-8s %10zu %10zu %10zu %10zu %8lld %10zu %10zu\n", retro_material_name(stats.material).c_str(), stats.entries,
+               stats.wins, stats.draws, stats.losses, static_cast<long long>(stats.milliseconds), stats.raw_bytes, stats.file_bytes);
+    }
+}
+
+int main(){
+    check_king_pairs();
+
+    RetroGenerator generator;
+    for(const char *name : {"KQvK", "KRvK", "KBNvK", "KRvKN", "KQvKR"})
+        assert(generator.generate(name));
+    assert(!generator.generate("KPvK") && !generator.generate("KQRBNvK"));
+    print_stats(generator);
+
+    chess::Tablebases tablebases;
+    chess::TbGenerator mailbox_generator(tablebases);
+    for(const char *name : {"KQvK", "KRvK", "KBvK", "KNvK"}){
+        assert(mailbox_generator.generate(name));
+        check_against_mailbox(generator, tablebases, name);
+        check_against_mtb(generator, tablebases, name);
+    }
+    check_one_ply(generator, "KBNvK", 7);
+    check_one_ply(generator, "KRvKN", 7);
+    check_one_ply(generator, "KQvKR", 7);
+
+    check_file(generator, "KQvKR");
+    check_probe(generator);
+}
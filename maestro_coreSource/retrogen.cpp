@@ -0,0 +1,44 @@
+#include "retro.hpp"
+#include <cstdio>
+#include <string>
+
+using namespace std;
+using namespace maestro;
+
+// retrogen [-t threads] [-o directory] <material>...
+// generates the pawnless materials ("KQvKR") and the ones they capture into,
+// writes <directory>/<material>.mwdl for each and prints the time and size of every table
+
+int main(int argc, char **argv){
+    int threads = thread::hardware_concurrency();
+    string directory = ".";
+    vector<string> names;
+    for(int i = 1; i < argc; ++i){
+        const string arg = argv[i];
+        if((arg == "-t") && (i + 1 < argc))
+            threads = max(1, atoi(argv[++i]));
+        else if((arg == "-o") && (i + 1 < argc))
+            directory = argv[++i];
+        else
+            names.push_back(arg);
+    }
+
+    RetroGenerator generator(threads);
+    for(const string &name : names){
+        if(!generator.generate(name)){
+            fprintf(stderr, "can't generate %s\n", name.c_str());
+            return 1;
+        }
+    }
+
+    printf("%-8s %12s %8s %12s %12s %7s\n", "material", "entries", "ms", "raw bytes", "file bytes", "ratio");
+    for(const RetroStats &stats : generator.get_stats()){
+        const string name = retro_material_name(stats.material);
+        if(!generator.save(stats.material, (directory + "/" + name + ".mwdl").c_str())){
+            fprintf(stderr, "can't write %s/%s.mwdl\n", directory.c_str(), name.c_str());
+            return 1;
+        }
+        printf("%-8s %12zu %8lld %12zu %12zu %7.1f\n", name.c_str(), stats.entries, static_cast<long long>(stats.milliseconds),
+               stats.raw_bytes, stats.file_bytes, double(stats.raw_bytes) / stats.file_bytes);
+    }
+}
@@ -447,9 +447,9 @@ namespace maestro{
         return bit_at(lion);
     }
     
-    std::array<u64, 4096> gen_check_pin_mask_aggressor_defender(){
+    consteval std::array<u64, 4096> gen_check_pin_mask_aggressor_defender(){
         std::array<u64, 4096> check_pin_mask;
-        std::fill(check_pin_mask.begin(), check_pin_mask.end(), 0);
+        check_pin_mask.fill(0);
         for(int i = 0; i < 64; ++i){
             for(int j = 0; j < 64; ++j){
                 check_pin_mask[(i << 6) + j] = gen_check_pin_mask_aggressor_defender_on_squares(i, j);
@@ -473,7 +473,7 @@ namespace maestro{
     constexpr std::array<u64, 64> bishops_magic                         {gen_bishop_magic()};
     constexpr std::array<u64, 64> rook_xray                             {gen_rook_xray()};
     constexpr std::array<u64, 64> bishop_xray                           {gen_bishop_xray()};
-    const     std::array<u64, 4096> check_pin_mask_aggressor_defender   {gen_check_pin_mask_aggressor_defender()};
+    constexpr std::array<u64, 4096> check_pin_mask_aggressor_defender   {gen_check_pin_mask_aggressor_defender()};
     
     
     constexpr u64 get_check_pin_mask_aggressor_defender(const Square aggressor, const Square defender)noexcept{
@@ -595,50 +595,158 @@ namespace maestro{
         return res;
     }
     
-    constexpr std::array<std::array<u64, 4096>, 64> gen_rooks_attacks(){
-        std::array<std::array<u64, 4096>, 64> attaks;
-        for(auto &i : attaks){
-            i.fill(0);
+    /// NOTE: slider attacks are packed one square after another, every square takes only
+    /// 2^popcount(vision) entries instead of the worst case 4096 (512 for bishops)
+    consteval std::array<u32, 65> gen_rooks_attacks_offset(){
+        std::array<u32, 65> offsets;
+        offsets[0] = 0;
+        for(int i = 0; i < 64; ++i){
+            offsets[i + 1] = offsets[i] + (1u << std::popcount(rooks_vision[i]));
         }
+        return offsets;
+    }
+    
+    consteval std::array<u32, 65> gen_bishops_attacks_offset(){
+        std::array<u32, 65> offsets;
+        offsets[0] = 0;
         for(int i = 0; i < 64; ++i){
-            u64 end = 1 <<  std::popcount(rooks_vision[i]);
-            for(u64 maskId = 0; maskId < end; ++maskId){
-                u64 mask = _pdep_u64(maskId, rooks_vision[i]);
-                u64 moveMask = rooks_move_mask_on_mask_id(mask, i);
-                attaks[i][maskId] = moveMask;
-            }
+            offsets[i + 1] = offsets[i] + (1u << std::popcount(bishops_vision[i]));
         }
-        return attaks;
+        return offsets;
     }
     
-    constexpr std::array<std::array<u64, 512>, 64> gen_bishops_attacks(){
-        std::array<std::array<u64, 512>, 64> attaks;
-        for(auto &i : attaks){
-            i.fill(0);
+    constexpr std::array<u32, 65> rooks_attacks_offset                  {gen_rooks_attacks_offset()};
+    constexpr std::array<u32, 65> bishops_attacks_offset                {gen_bishops_attacks_offset()};
+    constexpr u32 rooks_attacks_size                                    {rooks_attacks_offset[64]};
+    constexpr u32 bishops_attacks_size                                  {bishops_attacks_offset[64]};
+    
+    enum RayDirection : int{
+        Ray_North = 0,
+        Ray_East,
+        Ray_Northeast,
+        Ray_Northwest,
+        
+        Ray_South,
+        Ray_West,
+        Ray_Southeast,
+        Ray_Southwest
+    };
+    
+    constexpr u64 ray_on_empty_board(const int i, const int j, const int step_i, const int step_j){
+        u64 mask = 0;
+        for(int ii = i + step_i, jj = j + step_j; is_legal(ii, jj); ii += step_i, jj += step_j){
+            mask |= mask_at_ij(ii, jj);
         }
-        for(int i = 0; i < 64; ++i){
-            u64 end = 1 <<  std::popcount(bishops_vision[i]);
-            for(u64 maskId = 0; maskId < end; ++maskId){
-                u64 mask = _pdep_u64(maskId, bishops_vision[i]);
-                u64 moveMask = bishops_move_mask_on_mask_id(mask, i);
-                attaks[i][maskId] = moveMask;
+        return mask;
+    }
+    
+    consteval std::array<std::array<u64, 64>, 8> gen_rays(){
+        std::array<std::array<u64, 64>, 8> rays;
+        for(int i = 0; i < 8; ++i){
+            for(int j = 0; j < 8; ++j){
+                rays[Ray_North][id_at_ij(i, j)]     = ray_on_empty_board(i, j,  1,  0);
+                rays[Ray_East][id_at_ij(i, j)]      = ray_on_empty_board(i, j,  0,  1);
+                rays[Ray_Northeast][id_at_ij(i, j)] = ray_on_empty_board(i, j,  1,  1);
+                rays[Ray_Northwest][id_at_ij(i, j)] = ray_on_empty_board(i, j,  1, -1);
+                rays[Ray_South][id_at_ij(i, j)]     = ray_on_empty_board(i, j, -1,  0);
+                rays[Ray_West][id_at_ij(i, j)]      = ray_on_empty_board(i, j,  0, -1);
+                rays[Ray_Southeast][id_at_ij(i, j)] = ray_on_empty_board(i, j, -1,  1);
+                rays[Ray_Southwest][id_at_ij(i, j)] = ray_on_empty_board(i, j, -1, -1);
+            }
+        }
+        return rays;
+    }
+    
+    constexpr std::array<std::array<u64, 64>, 8> rays                   {gen_rays()};
+    
+    /// NOTE: classical ray attacks, cut the ray behind the first blocker.
+    /// Cheap enough to fill the slider tables inside the constexpr operations limit
+    template<RayDirection direction>
+    constexpr u64 ray_attack(const int square, const u64 blocked){
+        u64 attack = rays[direction][square];
+        const u64 blockers = attack & blocked;
+        if(blockers != 0){
+            if constexpr(direction < Ray_South){
+                attack ^= rays[direction][bitscan(blockers)];
+            }
+            else{
+                attack ^= rays[direction][63 - __builtin_clzll(blockers)];
             }
         }
+        return attack;
+    }
+    
+    constexpr u64 rook_attack_on_blocked(const int square, const u64 blocked){
+        return ray_attack<Ray_North>(square, blocked) | ray_attack<Ray_East>(square, blocked)
+             | ray_attack<Ray_South>(square, blocked) | ray_attack<Ray_West>(square, blocked);
+    }
+    
+    constexpr u64 bishop_attack_on_blocked(const int square, const u64 blocked){
+        return ray_attack<Ray_Northeast>(square, blocked) | ray_attack<Ray_Northwest>(square, blocked)
+             | ray_attack<Ray_Southeast>(square, blocked) | ray_attack<Ray_Southwest>(square, blocked);
+    }
+    
+    /// NOTE: carry-rippler visits the subsets of vision in pext order, so the n-th subset is pdep(n, vision)
+    template<int square>
+    consteval std::array<u64, (1u << std::popcount(rooks_vision[square]))> gen_rooks_attacks_on_square(){
+        std::array<u64, (1u << std::popcount(rooks_vision[square]))> attaks;
+        u64 mask = 0;
+        u32 maskId = 0;
+        do{
+            attaks[maskId++] = rook_attack_on_blocked(square, mask);
+            mask = (mask - rooks_vision[square]) & rooks_vision[square];
+        }while(mask != 0);
+        return attaks;
+    }
+    
+    template<int square>
+    consteval std::array<u64, (1u << std::popcount(bishops_vision[square]))> gen_bishops_attacks_on_square(){
+        std::array<u64, (1u << std::popcount(bishops_vision[square]))> attaks;
+        u64 mask = 0;
+        u32 maskId = 0;
+        do{
+            attaks[maskId++] = bishop_attack_on_blocked(square, mask);
+            mask = (mask - bishops_vision[square]) & bishops_vision[square];
+        }while(mask != 0);
+        return attaks;
+    }
+    
+    /// NOTE: every square is its own constant evaluation, the whole table at once
+    /// exceeds the default -fconstexpr-ops-limit
+    template<int square>
+    constexpr auto rooks_attacks_on_square                              {gen_rooks_attacks_on_square<square>()};
+    
+    template<int square>
+    constexpr auto bishops_attacks_on_square                            {gen_bishops_attacks_on_square<square>()};
+    
+    template<int... squares>
+    consteval std::array<u64, rooks_attacks_size> gen_rooks_attacks(std::integer_sequence<int, squares...>){
+        std::array<u64, rooks_attacks_size> attaks;
+        ((std::copy(rooks_attacks_on_square<squares>.begin(), rooks_attacks_on_square<squares>.end(),
+                    attaks.begin() + rooks_attacks_offset[squares])), ...);
+        return attaks;
+    }
+    
+    template<int... squares>
+    consteval std::array<u64, bishops_attacks_size> gen_bishops_attacks(std::integer_sequence<int, squares...>){
+        std::array<u64, bishops_attacks_size> attaks;
+        ((std::copy(bishops_attacks_on_square<squares>.begin(), bishops_attacks_on_square<squares>.end(),
+                    attaks.begin() + bishops_attacks_offset[squares])), ...);
         return attaks;
     }
     
     
-    const std::array<std::array<u64, 4096>, 64> rooks_attacks     {gen_rooks_attacks()};
+    constexpr std::array<u64, rooks_attacks_size> rooks_attacks     {gen_rooks_attacks(std::make_integer_sequence<int, 64>())};
     
-    const std::array<std::array<u64, 512>, 64> bishops_attacks    {gen_bishops_attacks()};
+    constexpr std::array<u64, bishops_attacks_size> bishops_attacks {gen_bishops_attacks(std::make_integer_sequence<int, 64>())};
     
     
     inline u64 get_rook_attack_mask(const u64 BlockedBitsMask, const u32 square){
-        return rooks_attacks[square][get_rook_magic(BlockedBitsMask & rooks_vision[square], square)];
+        return rooks_attacks[rooks_attacks_offset[square] + get_rook_magic(BlockedBitsMask & rooks_vision[square], square)];
     }
     /// DONE: rename parameters
     inline u64 get_bishop_attack_mask(const u64 BlockedBitsMask, const u32 square){
-        return bishops_attacks[square][get_bishop_magic(BlockedBitsMask & bishops_vision[square], square)];
+        return bishops_attacks[bishops_attacks_offset[square] + get_bishop_magic(BlockedBitsMask & bishops_vision[square], square)];
     }
     
     inline u64 get_queen_attack(const u64 BlockedBitsMask, const u32 square){
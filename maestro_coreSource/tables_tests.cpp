@@ -0,0 +1,155 @@
+#include "maestro.hpp"
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+using namespace maestro;
+
+// xorshift64*, good enough to make occupancies that are not cache friendly
+u64 rand_state = 0x2545F4914F6CDD1Dull;
+u64 next_rand(){
+    rand_state ^= rand_state >> 12;
+    rand_state ^= rand_state << 25;
+    rand_state ^= rand_state >> 27;
+    return rand_state * 0x2545F4914F6CDD1Dull;
+}
+
+void check_sliders(){
+    for(int square = 0; square < 64; ++square){
+        const u64 rook_end = bit_at(popcount(rooks_vision[square]));
+        for(u64 mask_id = 0; mask_id < rook_end; ++mask_id){
+            const u64 blocked = pdep(mask_id, rooks_vision[square]);
+            assert(get_rook_attack_mask(blocked, square) == rooks_move_mask_on_mask_id(blocked, square));
+        }
+        const u64 bishop_end = bit_at(popcount(bishops_vision[square]));
+        for(u64 mask_id = 0; mask_id < bishop_end; ++mask_id){
+            const u64 blocked = pdep(mask_id, bishops_vision[square]);
+            assert(get_bishop_attack_mask(blocked, square) == bishops_move_mask_on_mask_id(blocked, square));
+        }
+    }
+    cout << "sliders SUCCESS\n";
+}
+
+// best of several runs, every lookup is paired with a random read from a buffer
+// of search_stack_size bytes to imitate the rest of the engine fighting for L2
+template<int search_stack_size>
+double bench_sliders(const vector<u64> &occupancy, const vector<u32> &squares){
+    static vector<u64> search_stack(search_stack_size / sizeof(u64) + 1);
+    const int lookups = occupancy.size();
+    double best = 1e18;
+    u64 sink = 0;
+    for(int run = 0; run < 5; ++run){
+        auto start = std::chrono::steady_clock::now();
+        for(int i = 0; i < lookups; ++i){
+            if constexpr(search_stack_size != 0){
+                sink += search_stack[(occupancy[i] >> 7) % search_stack.size()];
+            }
+            sink ^= get_queen_attack(occupancy[i], squares[i]);
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        best = min(best, ns / lookups);
+    }
+    if(sink == 42)cout << sink;
+    return best;
+}
+
+void bench_sliders(){
+    constexpr int lookups = 1 << 22;
+    vector<u64> occupancy(lookups);
+    vector<u32> squares(lookups);
+    for(int i = 0; i < lookups; ++i){
+        occupancy[i] = next_rand() & next_rand();
+        squares[i] = next_rand() & 63;
+    }
+    cout << "tables size: " << (sizeof(rooks_attacks) + sizeof(bishops_attacks)) / 1024 << " KiB\n";
+    cout << "queen lookups: " << bench_sliders<0>(occupancy, squares) << " ns/op\n";
+    cout << "queen lookups with 1 MiB of noise: " << bench_sliders<(1 << 20)>(occupancy, squares) << " ns/op\n";
+}
+
+u64 sliders_attack_by_lookup(const u64 rooks, const u64 bishops, const u64 blocked){
+    u64 mask = 0;
+    forBits(temp_mask, rooks){
+        mask |= get_rook_attack_mask(blocked, bitscan(temp_mask));
+    }
+    forBits(temp_mask, bishops){
+        mask |= get_bishop_attack_mask(blocked, bitscan(temp_mask));
+    }
+    return mask;
+}
+
+struct sliders_case{
+    u64 rooks, bishops, blocked;
+};
+
+vector<sliders_case> gen_sliders_cases(const int count){
+    vector<sliders_case> cases(count);
+    for(auto &i : cases){
+        i.blocked = next_rand() & next_rand();
+        // a side usually has 2 rooks, 2 bishops and a queen
+        for(int j = 0; j < 5; ++j){
+            const u64 piece = bit_at(next_rand() & 63);
+            (j < 3 ? i.rooks : i.bishops) |= piece;
+            i.blocked |= piece;
+        }
+    }
+    return cases;
+}
+
+void check_fill(){
+    for(const auto &i : gen_sliders_cases(1 << 16)){
+        const u64 expected = sliders_attack_by_lookup(i.rooks, i.bishops, i.blocked);
+        assert(get_sliders_attack_fill(i.rooks, i.bishops, ~i.blocked) == expected);
+        assert(get_sliders_attack_fill_scalar(i.rooks, i.bishops, ~i.blocked) == expected);
+    }
+    const string fens[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10"
+    };
+    for(const auto &fen : fens){
+        Board brd;
+        brd.parse_from_FEN(fen);
+        assert(brd.gen_sliders_attacked_mask_fill<Color_White>() == sliders_attack_by_lookup(
+            brd.My_Rooks<Color_White>() | brd.My_Queens<Color_White>(), brd.My_Bishops<Color_White>() | brd.My_Queens<Color_White>(), brd.Not_free));
+        assert(brd.gen_sliders_attacked_mask_fill<Color_Black>() == sliders_attack_by_lookup(
+            brd.My_Rooks<Color_Black>() | brd.My_Queens<Color_Black>(), brd.My_Bishops<Color_Black>() | brd.My_Queens<Color_Black>(), brd.Not_free));
+    }
+    cout << "fill SUCCESS\n";
+}
+
+template<typename Generator>
+double bench_attack_masks(const vector<sliders_case> &cases, Generator generator){
+    double best = 1e18;
+    u64 sink = 0;
+    for(int run = 0; run < 5; ++run){
+        auto start = std::chrono::steady_clock::now();
+        for(const auto &i : cases){
+            sink ^= generator(i.rooks, i.bishops, i.blocked);
+        }
+        auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        best = min(best, ns / cases.size());
+    }
+    if(sink == 42)cout << sink;
+    return best;
+}
+
+void bench_fill(){
+    const vector<sliders_case> cases = gen_sliders_cases(1 << 20);
+    cout << "sliders attack mask, lookup per piece: " << bench_attack_masks(cases, sliders_attack_by_lookup) << " ns/op\n";
+    cout << "sliders attack mask, AVX2 fill: " << bench_attack_masks(cases, [](const u64 rooks, const u64 bishops, const u64 blocked){
+        return get_sliders_attack_fill(rooks, bishops, ~blocked);
+    }) << " ns/op\n";
+    cout << "sliders attack mask, scalar fill: " << bench_attack_masks(cases, [](const u64 rooks, const u64 bishops, const u64 blocked){
+        return get_sliders_attack_fill_scalar(rooks, bishops, ~blocked);
+    }) << " ns/op\n";
+}
+
+int main(){
+    check_sliders();
+    check_fill();
+    bench_sliders();
+    bench_fill();
+}
@@ -6,6 +6,8 @@
 #include <bit>
 #include <immintrin.h>
 #include <tuple>
+#include <algorithm>
+#include <utility>
 
 namespace maestro{
     using u8  = uint8_t;
@@ -205,12 +207,12 @@ namespace maestro{
     }
 
     template<typename T>
-    constexpr Square operator+(const PieceType piece_type, const T value)noexcept{
+    constexpr PieceType operator+(const PieceType piece_type, const T value)noexcept{
         return static_cast<PieceType>(static_cast<T>(piece_type) + value);
     }
     
     template<typename T>
-    constexpr Square operator-(const PieceType piece_type, const T value)noexcept{
+    constexpr PieceType operator-(const PieceType piece_type, const T value)noexcept{
         return static_cast<PieceType>(static_cast<T>(piece_type) - value);
     }
     
@@ -346,7 +348,7 @@ namespace maestro{
         constexpr void add(const Move_full_info& move){
             *(end++) = move;
         }
-        constexpr Move peek(){
+        constexpr Move_full_info peek(){
             return *end;
         }
         constexpr void pop(){
@@ -354,7 +356,7 @@ namespace maestro{
         }
         constexpr void add_plain_moves(const int from_id, u64 moves_mask){
             forMask(moves_mask){
-                *(end++) = Create_move_full_info(from_id, bitscan(moves_mask), No_promotion, No_special);
+                *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(bitscan(moves_mask)), No_promotion, No_special);
             }
         }
         template<Color clr>
@@ -362,22 +364,22 @@ namespace maestro{
             forMask(moves_mask){
                 const int to_id = bitscan(moves_mask);
                 if((to_id & last_rank<clr>()) != 0){
-                    *(end++) = Create_move_full_info(from_id, to_id, promote_to_queen, SP_Promotion);
-                    *(end++) = Create_move_full_info(from_id, to_id, promote_to_rook, SP_Promotion);
-                    *(end++) = Create_move_full_info(from_id, to_id, promote_to_bishop, SP_Promotion);
-                    *(end++) = Create_move_full_info(from_id, to_id, promote_to_knight, SP_Promotion);
+                    *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), promote_to_queen, SP_Promotion);
+                    *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), promote_to_rook, SP_Promotion);
+                    *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), promote_to_bishop, SP_Promotion);
+                    *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), promote_to_knight, SP_Promotion);
                 }
                 else{
-                    *(end++) = Create_move_full_info(from_id, bitscan(moves_mask), No_promotion, No_special);
+                    *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(bitscan(moves_mask)), No_promotion, No_special);
                 }
             }
         }
         constexpr void add_plain_move(const int from_id, const int to_id){
-            *(end++) = Create_move_full_info(from_id, to_id, No_promotion, No_special);
+            *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), No_promotion, No_special);
         }
         template<Color clr>
         constexpr void add_en_passant(const int from_id, const int to_id){
-            *(end++) = Create_move_full_info(from_id, to_id, No_promotion, SP_en_passant);
+            *(end++) = Create_move_full_info(static_cast<Square>(from_id), static_cast<Square>(to_id), No_promotion, SP_en_passant);
         }
         //constexpr void
         constexpr bool no_moves(){
@@ -0,0 +1,112 @@
+#include "MainLogic/match.hpp"
+#include <cassert>
+#include <iostream>
+using namespace std;
+using namespace chess;
+
+// plays the given moves in turn, with a fixed score
+class ScriptedEngine : public MatchEngine{
+    vector<string> script;
+    size_t next = 0;
+    int score;
+public:
+    ScriptedEngine(vector<string> moves, const int fixed_score = 0) : script(std::move(moves)), score(fixed_score){}
+    void new_game() override{ next = 0; }
+    EngineMove go(const string &, const vector<string> &) override{
+        return {(next < script.size()) ? script[next++] : "", score};
+    }
+};
+
+void check_sprt(){
+    Sprt sprt;
+    assert(sprt.lower_bound() < 0 && sprt.upper_bound() > 0);
+    assert(sprt.llr(0, 0, 0) == 0.0);
+    assert(sprt.decision(0, 10, 0) == 0);
+    assert(sprt.llr(600, 200, 400) > 0.0 && sprt.llr(400, 200, 600) < 0.0);
+    assert(sprt.decision(6000, 2000, 4000) == 1);
+    assert(sprt.decision(4000, 2000, 6000) == -1);
+    assert(sprt.decision(10, 10, 10) == 0);
+    // a one-sided run has no losses or no wins and must still stop, on the right side
+    int64_t games = 0;
+    while(sprt.decision(0, 0, games) == 0)
+        ++games;
+    assert(sprt.decision(0, 0, games) == -1 && games < 100);
+    games = 0;
+    while(sprt.decision(games, 0, 0) == 0)
+        ++games;
+    assert(sprt.decision(games, 0, 0) == 1 && games < 100);
+    const auto [elo, margin] = elo_estimate(600, 200, 400);
+    assert(elo > 50 && elo < 80 && margin > 0 && margin < 30);
+    assert(elo_estimate(10, 0, 10).first == 0.0);
+    cout << "sprt SUCCESS\n";
+}
+
+void check_rules(){
+    Adjudication none{0, 0, 0, 0, 0, 0, nullptr};
+    string reason;
+
+    ScriptedEngine fool_white({"f2f3", "g2g4"}), fool_black({"e7e5", "d8h4"});
+    assert(play_game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", fool_white, fool_black, none, &reason) == Black_wins);
+    assert(reason == "checkmate");
+
+    ScriptedEngine knights_white({"g1f3", "f3g1", "g1f3", "f3g1"}), knights_black({"g8f6", "f6g8", "g8f6", "f6g8"});
+    assert(play_game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", knights_white, knights_black, none, &reason) == Game_drawn);
+    assert(reason == "repetition");
+
+    ScriptedEngine rook_white({"b1b2"}), rook_black({"h8h7"});
+    assert(play_game("k6r/8/8/8/8/8/8/1R4K1 w - - 99 80", rook_white, rook_black, none, &reason) == Game_drawn);
+    assert(reason == "fifty moves");
+
+    ScriptedEngine capture_white({"b1a3"}), capture_black({});
+    assert(play_game("7k/8/8/8/8/p7/8/1N5K w - - 0 1", capture_white, capture_black, none, &reason) == Game_drawn);
+    assert(reason == "insufficient material");
+
+    ScriptedEngine illegal_white({"e2e5"}), idle_black({});
+    assert(play_game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", illegal_white, idle_black, none, &reason) == Black_wins);
+    assert(reason == "illegal move");
+
+    // white is sure it wins and black agrees, for two plies each
+    Adjudication resign = none;
+    resign.resign_score = 500;
+    resign.resign_plies = 2;
+    ScriptedEngine sure_white({"g1f3", "f3g1"}, 900), sure_black({"g8f6", "f6g8"}, -900);
+    assert(play_game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", sure_white, sure_black, resign, &reason) == White_wins);
+    assert(reason == "resign");
+    cout << "rules SUCCESS\n";
+}
+
+void check_match(){
+    SearchLimits deep, shallow;
+    deep.depth = 3;
+    shallow.depth = 1;
+    Adjudication adjudication;
+    adjudication.max_plies = 120;
+    Match match({"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1",
+                 "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2"}, adjudication, nullopt);
+    int64_t reported = 0;
+    const MatchScore score = match.run(4, 2, [&](const int engine){ return make_unique<BuiltinEngine>(engine == 0 ? deep : shallow); },
+        [&](const MatchScore &total, int64_t, GameResult, const string &reason){
+            assert(total.games() == ++reported);
+            assert(!reason.empty());
+        });
+    assert(score.games() == 4 && reported == 4);
+    cout << "+" << score.wins << " =" << score.draws << " -" << score.losses << "\n";
+    assert(score.wins > score.losses);
+    cout << "match SUCCESS\n";
+}
+
+void check_uci_scores(){
+    assert(score_to_uci(35) == "cp 35" && score_to_uci(-35) == "cp -35");
+    assert(score_to_uci(mate_score - 1) == "mate 1" && score_to_uci(mate_score - 3) == "mate 2");
+    assert(score_to_uci(-mate_score + 2) == "mate -1" && score_to_uci(-mate_score + 4) == "mate -2");
+    // a table win stays under the mate band and keeps its order
+    assert(score_to_uci(tb_win - 3) == "cp 19997" && score_to_uci(-tb_win + 3) == "cp -19997");
+    cout << "uci scores SUCCESS\n";
+}
+
+int main(){
+    check_sprt();
+    check_uci_scores();
+    check_rules();
+    check_match();
+}
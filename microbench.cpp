@@ -0,0 +1,189 @@
+#include "MainLogic/fenView.hpp"
+#include "MainLogic/movegen.hpp"
+#include "Board/board.hpp"
+#include "maestro_coreSource/tables.hpp"
+#include "profile.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace chess;
+
+// microbench [-r repetitions] [-t milliseconds] [filter]
+// times the building blocks over a fixed position set, every benchmark grows its round count until a
+// repetition takes the target time and reports the fastest repetition in ns and TSC cycles per op,
+// a filter runs only the benchmarks whose name contains it
+
+const char *fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bq1rk1/pp2bppp/2n1pn2/3p4/2PP4/2N1PN2/PP3PPP/R2QKB1R w KQ - 0 8",
+    "2r3k1/5pp1/p3p2p/1p1qP3/3P4/P4Q1P/1P3PP1/2R3K1 b - - 0 28",
+    "6k1/5p2/6p1/8/7p/8/6PP/6K1 b - - 0 1",
+    "8/8/1p1k4/p1p5/P1P2K2/1P6/8/8 w - - 0 50"
+};
+
+// keeps value alive without reading it back
+template<typename T>
+inline void do_not_optimize(const T &value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result{
+    double ns;
+    double cycles;
+};
+
+int repetitions = 5;
+double target_ms = 50;
+const char *filter = nullptr;
+
+// body(rounds) runs the operation ops_per_round * rounds times
+template<typename Body>
+void run(const char *name, const int64_t ops_per_round, Body body){
+    if((filter != nullptr) && (strstr(name, filter) == nullptr))
+        return;
+    int64_t rounds = 1;
+    for(;;){
+        const auto start = chrono::steady_clock::now();
+        body(rounds);
+        const double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if(ms >= target_ms / 4)
+            break;
+        rounds *= 4;
+    }
+    Result best{1e30, 1e30};
+    for(int i = 0; i < repetitions; ++i){
+        const auto start = chrono::steady_clock::now();
+        const u64 start_cycles = profile_clock();
+        body(rounds);
+        const u64 cycles = profile_clock() - start_cycles;
+        const double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        const double ops = double(ops_per_round) * rounds;
+        best = {min(best.ns, ns / ops), min(best.cycles, cycles / ops)};
+    }
+    printf("%-24s %12.2f ns/op %12.1f cycles/op %14lld ops\n", name, best.ns, best.cycles,
+           static_cast<long long>(ops_per_round * rounds));
+}
+
+template<typename F>
+inline auto with_turn(const Board &brd, F &&f){
+    return brd.get_turn() ? f.template operator()<White>() : f.template operator()<Black>();
+}
+
+int main(int argc, char **argv){
+    for(int i = 1; i < argc; ++i){
+        const string arg = argv[i];
+        if((arg == "-r") && (i + 1 < argc))
+            repetitions = max(1, atoi(argv[++i]));
+        else if((arg == "-t") && (i + 1 < argc))
+            target_ms = atof(argv[++i]);
+        else
+            filter = argv[i];
+    }
+
+    PawnHashTable pawn_table;
+    vector<Board> boards;
+    for(const char *fen : fens){
+        boards.emplace_back();
+        if(const FenError error = parse_fen(fen, boards.back())){
+            fprintf(stderr, "%s: %s\n", fen, fen_error_message(error.code));
+            return 1;
+        }
+    }
+    Movelist<5000> list;
+    // the legal moves of every position, for make/undo and the incremental hash
+    vector<vector<Move_full_info>> moves;
+    int64_t move_count = 0;
+    for(Board &brd : boards){
+        Movelist_ref list_ref(list);
+        Movegen generator(brd, list_ref);
+        with_turn(brd, [&]<Color clr>(){ return generator.gen_all_moves<clr>(); });
+        moves.emplace_back(list_ref.begin, list_ref.end);
+        move_count += moves.back().size();
+    }
+    const int64_t board_count = boards.size();
+
+    // random occupancies, a fresh one for every call so the lookups are not all cached
+    vector<u64> occupancies(4096);
+    u64 state = 0x2545F4914F6CDD1Dull;
+    for(u64 &occupancy : occupancies){
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        occupancy = (state * 0x2545F4914F6CDD1Dull) & (state >> 7);
+    }
+    run("get_rook_attack_mask", occupancies.size(), [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(size_t i = 0; i < occupancies.size(); ++i)
+                do_not_optimize(maestro::get_rook_attack_mask(occupancies[i], i & 63));
+        }
+    });
+
+    run("gen_all_moves", board_count, [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(Board &brd : boards){
+                Movelist_ref list_ref(list);
+                Movegen generator(brd, list_ref);
+                do_not_optimize(with_turn(brd, [&]<Color clr>(){ return generator.gen_all_moves<clr>(); }));
+                do_not_optimize(list_ref.end);
+            }
+        }
+    });
+
+    // one op is a make and its undo
+    run("make_undo_move", move_count, [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(int64_t b = 0; b < board_count; ++b){
+                Board &brd = boards[b];
+                with_turn(brd, [&]<Color clr>(){
+                    for(const Move_full_info move : moves[b]){
+                        const Accumulator acc = brd.unstable_make_move<clr>(move);
+                        do_not_optimize(brd);
+                        brd.unstable_undo_move<clr>(move, acc);
+                    }
+                    return 0;
+                });
+            }
+        }
+    });
+
+    run("get_hash", board_count, [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(Board &brd : boards){
+                do_not_optimize(brd);
+                do_not_optimize(brd.get_hash());
+            }
+        }
+    });
+
+    run("get_hash_incremental", move_count, [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(int64_t b = 0; b < board_count; ++b){
+                Board &brd = boards[b];
+                u64 hash = 0;
+                with_turn(brd, [&]<Color clr>(){
+                    for(const Move_full_info move : moves[b])
+                        hash = brd.get_hash<clr>(hash, move);
+                    return 0;
+                });
+                do_not_optimize(hash);
+            }
+        }
+    });
+
+    run("eval_position", board_count, [&](const int64_t rounds){
+        for(int64_t r = 0; r < rounds; ++r){
+            for(Board &brd : boards){
+                do_not_optimize(brd);
+                do_not_optimize(brd.eval_position(&pawn_table));
+            }
+        }
+    });
+}
@@ -0,0 +1,137 @@
+#include "MainLogic/fenView.hpp"
+#include "Board/nnue.hpp"
+#include "ai.hpp"
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <unistd.h>
+using namespace std;
+using namespace chess;
+
+Movelist<5000> list;
+
+const string positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "rnbqkbnr/ppp1pppp/8/2Pp4/8/8/PP1PPPPP/RNBQKBNR w KQkq d6 0 3"
+};
+
+NnueNetwork network;
+
+// the incremental accumulators equal a refresh at every node, evaluated at every other ply on the way down
+template<Color clr>
+int64_t walk(Board &brd, NnueStack<64> &stack, const int d, Movelist_ref list_ref){
+    if(d % 2 == 0){
+        NnueStack<64> fresh;
+        fresh.set_network(&network);
+        fresh.reset(brd);
+        const int score = stack.evaluate<clr>(brd);
+        assert(score == fresh.evaluate<clr>(brd));
+        assert(stack.get_accumulator().values == fresh.get_accumulator().values);
+        const NnueAccumulator &acc = stack.get_accumulator();
+        assert(network.output_scalar(acc.values[clr].data(), acc.values[change_color(clr)].data()) == score);
+    }
+    if(d == 0)
+        return 1;
+    Movegen generator(brd, list_ref);
+    generator.gen_all_moves<clr>();
+    int64_t nodes = 0;
+    for(Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+        stack.push<clr>(brd, *i);
+        const Accumulator acc = brd.unstable_make_move<clr>(*i);
+        nodes += walk<change_color(clr)>(brd, stack, d - 1, list_ref.get_ref());
+        brd.unstable_undo_move<clr>(*i, acc);
+        stack.pop();
+    }
+    return nodes;
+}
+
+void check_incremental(){
+    for(const string &fen : positions){
+        Board brd;
+        assert(!parse_fen(fen, brd));
+        NnueStack<64> stack;
+        stack.set_network(&network);
+        stack.reset(brd);
+        Movelist_ref list_ref(list);
+        const int64_t nodes = brd.get_turn() ? walk<White>(brd, stack, 3, list_ref) : walk<Black>(brd, stack, 3, list_ref);
+        cout << fen << ": " << nodes << " nodes SUCCESS\n";
+    }
+}
+
+void check_kernels(){
+    mt19937_64 random(7);
+    uniform_int_distribution<int> value(-400, 400);
+    alignas(32) types::array<i16, nnue_hidden> in, rows[4], simd, scalar;
+    types::array<i8, 2 * nnue_hidden> weights;
+    for(int round = 0; round < 100; ++round){
+        for(i16 &x : in)
+            x = static_cast<i16>(value(random));
+        for(auto &row : rows){
+            for(i16 &x : row)
+                x = static_cast<i16>(value(random) / 8);
+        }
+        for(i8 &x : weights)
+            x = static_cast<i8>(value(random) % 128);
+        const i16 *added[] = {rows[0].data(), rows[1].data()}, *removed[] = {rows[2].data(), rows[3].data()};
+        nnue_update(simd.data(), in.data(), added, 2, removed, 2);
+        nnue_update_scalar(scalar.data(), in.data(), added, 2, removed, 2);
+        assert(simd == scalar);
+        assert(nnue_output(in.data(), simd.data(), weights.data()) == nnue_output_scalar(in.data(), simd.data(), weights.data()));
+    }
+    cout << "kernels SUCCESS\n";
+}
+
+void check_file(){
+    const char *path = "/tmp/nnue_tests.mnn";
+    assert(network.save(path));
+    NnueNetwork loaded;
+    assert(loaded.load(path));
+    Board brd;
+    assert(!parse_fen(positions[1], brd));
+    NnueStack<64> original, copy;
+    original.set_network(&network);
+    copy.set_network(&loaded);
+    original.reset(brd);
+    copy.reset(brd);
+    assert(original.evaluate<White>(brd) == copy.evaluate<White>(brd));
+    assert(original.get_accumulator().values == copy.get_accumulator().values);
+
+    // a cut file loads nothing
+    assert(truncate(path, 1000) == 0);
+    assert(!loaded.load(path) && !loaded.is_loaded());
+    remove(path);
+    assert(!loaded.load("/tmp/nnue_tests_missing.mnn"));
+    cout << "file SUCCESS\n";
+}
+
+// the same search through the AI, with the tables and with the network
+void check_search(){
+    Board brd;
+    assert(!parse_fen(positions[1], brd));
+    Movelist_ref list_ref(list);
+    AI bot(brd, list_ref);
+    bot.set_eval_cache_size(0);
+    for(const bool with_network : {false, true}){
+        bot.set_network(with_network ? &network : nullptr);
+        assert(bot.uses_network() == with_network);
+        const auto start = chrono::steady_clock::now();
+        const Move_full_info move = get<0>(bot.best_move_ab(4));
+        const auto end = chrono::steady_clock::now();
+        assert(move.from_square != No_Square);
+        const double seconds = chrono::duration<double>(end - start).count();
+        cout << (with_network ? "network: " : "tables: ") << bot.all_nodes << " nodes, " << int64_t(bot.all_nodes / seconds) << " nps\n";
+    }
+    cout << "search SUCCESS\n";
+}
+
+int main(){
+    network.randomize(2024);
+    check_kernels();
+    check_incremental();
+    check_file();
+    check_search();
+}
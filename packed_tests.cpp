@@ -0,0 +1,113 @@
+#include "MainLogic/fenView.hpp"
+#include "Board/board.hpp"
+#include "Board/packed.hpp"
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstring>
+#include <chrono>
+using namespace std;
+using namespace chess;
+
+const string positions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbqkbnr/1ppppppp/8/8/pP6/8/P1PPPPPP/RNBQKBNR b KQkq b3 0 2",
+    "8/PPP4k/8/8/8/8/ppp4K/8 b - - 37 120"
+};
+
+// encode then decode gives the same board, from either side
+void check_round_trip(){
+    char buffer[fen_buffer_size];
+    for(const string &fen : positions){
+        Board brd;
+        assert(!parse_fen(fen, brd));
+        PackedPosition packed;
+        assert(packed.encode(brd, -42));
+        assert(packed.score == -42);
+
+        Board decoded;
+        packed.decode(decoded);
+        assert(decoded == brd);
+        assert(string_view(buffer, write_fen(buffer, decoded)) == fen);
+
+        maestro::Board bitboards, decoded_bitboards;
+        assert(!parse_fen(fen, bitboards));
+        PackedPosition packed_bitboards;
+        assert(packed_bitboards.encode(bitboards, -42));
+        assert(memcmp(&packed, &packed_bitboards, sizeof(PackedPosition)) == 0);
+        packed.decode(decoded_bitboards);
+        assert(decoded_bitboards == bitboards);
+        cout << fen << " SUCCESS\n";
+    }
+
+    Board brd;
+    assert(!parse_fen("rnbqkbnr/pppppppp/PPPPPPPP/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", brd));
+    PackedPosition packed;
+    assert(!packed.encode(brd));
+}
+
+void check_reader(){
+    const char *path = "/tmp/packed_tests.bin";
+    vector<PackedPosition> records;
+    for(const string &fen : positions){
+        Board brd;
+        parse_fen(fen, brd);
+        records.emplace_back().encode(brd);
+    }
+    FILE *file = fopen(path, "wb");
+    assert(file != nullptr);
+    assert(write_packed(file, records));
+    fclose(file);
+
+    PackedReader reader(path);
+    assert(reader.is_open() && (reader.size() == records.size()));
+    size_t id = 0;
+    for(const PackedPosition &packed : reader){
+        assert(memcmp(&packed, &records[id++], sizeof(PackedPosition)) == 0);
+    }
+    assert(!PackedReader("/tmp/packed_tests_missing.bin").is_open());
+    remove(path);
+    cout << "reader SUCCESS\n";
+}
+
+void bench(){
+    const int runs = 200'000;
+    vector<PackedPosition> records;
+    for(const string &fen : positions){
+        Board brd;
+        parse_fen(fen, brd);
+        records.emplace_back().encode(brd);
+    }
+
+    Board brd;
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i){
+        parse_fen(positions[i % size(positions)], brd);
+        checksum += brd.get_total_moves();
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double fen_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for(int i = 0; i < runs; ++i){
+        records[i % records.size()].decode(brd);
+        checksum -= brd.get_total_moves();
+    }
+    end = std::chrono::steady_clock::now();
+    const double packed_time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    assert(checksum == 0);
+    cout << "parse_fen: " << fen_time / runs << " ns/position, decode: " << packed_time / runs << " ns/position\n";
+}
+
+int main(){
+    check_round_trip();
+    check_reader();
+    bench();
+}
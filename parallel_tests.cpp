@@ -0,0 +1,83 @@
+#include "MainLogic/fenView.hpp"
+#include "MainLogic/parallel.hpp"
+#include "ai.hpp"
+#include <cassert>
+#include <iostream>
+using namespace std;
+using namespace chess;
+
+void check_table(){
+    TranspositionTable tt(1);
+    const u64 key = 0x1234'5678'9ABC'DEF0ull, other = key ^ 0x8000'0000'0000'0000ull;
+    assert(!tt.probe(key).found);
+    const Move move = Move_full_info(12, 28, No_promotion, No_special).to_move();
+    tt.store(key, -300'000, 5, TT_Lower, move);
+    TTProbe entry = tt.probe(key);
+    assert(entry.found && entry.score == -300'000 && entry.depth == 5 && entry.bound == TT_Lower && entry.move == move);
+    // the same slot with a different key misses
+    assert(!tt.probe(other).found);
+    // shallower results of the same position keep the deeper one, another position replaces it
+    tt.store(key, 10, 3, TT_Exact, 0);
+    assert(tt.probe(key).depth == 5);
+    tt.store(key, 10, 7, TT_Exact, 0);
+    assert(tt.probe(key).depth == 7 && tt.probe(key).score == 10);
+    tt.store(other, 20, 1, TT_Upper, 0);
+    assert(tt.probe(other).found && !tt.probe(key).found);
+
+    assert(!tt.is_searching(key));
+    tt.start_search(key);
+    tt.start_search(key);
+    tt.finish_search(key);
+    assert(tt.is_searching(key));
+    tt.finish_search(key);
+    assert(!tt.is_searching(key));
+    tt.clear();
+    assert(!tt.probe(other).found);
+    cout << "table SUCCESS\n";
+}
+
+// the same position searched by one and by several threads, the table must not change what is found
+void check_search(const string &fen, const int depth, const int threads, const int expected_score){
+    Board brd;
+    assert(!parse_fen(fen, brd));
+    Movelist<5000> list;
+    Movelist_ref list_ref(list);
+    auto ai = make_unique<AI>(brd, list_ref);
+    ParallelSearch parallel(4);
+    parallel.set_threads(threads);
+    assert(parallel.get_threads() == threads);
+    SearchLimits limits;
+    limits.depth = depth;
+    const auto [move, score] = parallel.search(*ai, brd, limits, [](const SearchInfo&){});
+    assert(score == expected_score);
+    // the main board is untouched and the move is legal in it
+    Board copy;
+    parse_fen(fen, copy);
+    assert(copy == brd);
+    Movelist<512> legal;
+    Movelist_ref legal_ref(legal);
+    Movegen generator(copy, legal_ref);
+    copy.get_turn() ? generator.gen_all_moves<White>() : generator.gen_all_moves<Black>();
+    assert(find(legal_ref.begin, legal_ref.end, move) != legal_ref.end);
+    if constexpr(SearchStats::enabled)
+        assert(ai->get_stats().get_tt_probes() > 0);
+    cout << fen << " threads " << threads << ": " << square_to_str(static_cast<Square>(move.from_square)) << square_to_str(static_cast<Square>(move.to_square)) << " " << score << " nodes " << ai->all_nodes + parallel.helper_nodes() << "\n";
+}
+
+int main(){
+    check_table();
+    // mate in two
+    for(const int threads : {1, 2, 4})
+        check_search("r2qkb1r/pp2nppp/3p4/2pNN1B1/2BnP3/3P4/PPP2PPP/R2bK2R w KQkq - 1 1", 4, threads, mate_score - 3);
+    // the plain search's score at a depth where the table can't see further than it
+    Board brd;
+    const string fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    parse_fen(fen, brd);
+    Movelist<5000> list;
+    Movelist_ref list_ref(list);
+    AI plain(brd, list_ref);
+    const int score = get<1>(plain.best_move_ab(3));
+    for(const int threads : {1, 3})
+        check_search(fen, 3, threads, score);
+    cout << "search SUCCESS\n";
+}
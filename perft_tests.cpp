@@ -2,6 +2,8 @@
 #include "Graphic/graphic.hpp"
 #include "Board/board.hpp"
 #include "MainLogic/movegen.hpp"
+#include "Board/position.hpp"
+#include "Board/copymake.hpp"
 #include "tables.hpp"
 #include <string>
 #include <cassert>
@@ -29,13 +31,79 @@ int perft(Board &brd, int d, Movelist_ref list_ref = Movelist_ref(list)){
     
     int nodes = 0;
     for (Move_full_info *i = list_ref.begin; i < list_ref.end; ++i){
-        const Accumulator acc = brd.get_accumulator();
-        const Piece piece = brd[i->to_square];
-        brd.unstable_make_move<color>(*i);
+        const Accumulator acc = brd.unstable_make_move<color>(*i);
         const int local_nodes = perft<change_color(color)>(brd, d - 1, list_ref.get_ref());
         nodes += local_nodes;
-        brd.unstable_undo_move<color>(*i, piece);
-        brd.restore_info(acc);
+        brd.unstable_undo_move<color>(*i, acc);
+    }
+    return nodes;
+}
+
+BoardStack<64> board_stack;
+
+template<Color color>
+int copy_make_perft(Board &brd, int d, Movelist_ref list_ref = Movelist_ref(list)){
+    if(d == 0){
+        return 1;
+    }
+
+    Movegen generator(brd, list_ref);
+    generator.gen_all_moves<color>();
+
+    int nodes = 0;
+    for (Move_full_info *i = list_ref.begin; i < list_ref.end; ++i){
+        board_stack.push(brd);
+        brd.unstable_make_move<color>(*i);
+        nodes += copy_make_perft<change_color(color)>(brd, d - 1, list_ref.get_ref());
+        board_stack.pop(brd);
+    }
+    return nodes;
+}
+
+// make/undo against copy-make on the same trees
+void bench_copy_make(){
+    const pair<string, int> positions[] = {
+        {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5},
+        {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4}
+    };
+    fenParser parser;
+    for(const auto &[fen, d] : positions){
+        Board brd;
+        parser.parse_from_FEN(fen, brd);
+        const Board clone(brd);
+
+        auto start = std::chrono::steady_clock::now();
+        const int make_undo_nodes = perft<White>(brd, d);
+        auto end = std::chrono::steady_clock::now();
+        const double make_undo_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 1e-6;
+
+        start = std::chrono::steady_clock::now();
+        const int copy_make_nodes = copy_make_perft<White>(brd, d);
+        end = std::chrono::steady_clock::now();
+        const double copy_make_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() * 1e-6;
+
+        assert(make_undo_nodes == copy_make_nodes);
+        assert(clone == brd);
+        cout << fen << " make/undo: " << (make_undo_nodes / make_undo_time) << "nps copy-make: " << (copy_make_nodes / copy_make_time) << "nps\n";
+    }
+}
+
+// same walk on the dual representation, both sides must agree at every node
+template<Color color>
+int position_perft(Position &pos, int d, Movelist_ref list_ref = Movelist_ref(list)){
+    assert(pos.is_consistent());
+    if(d == 0){
+        return 1;
+    }
+
+    const PositionState state = pos.gen_moves<color>(list_ref);
+    assert(pos.in_check<color>() == (state != quite));
+
+    int nodes = 0;
+    for (Move_full_info *i = list_ref.begin; i < list_ref.end; ++i){
+        const Accumulator acc = pos.make_move<color>(*i);
+        nodes += position_perft<change_color(color)>(pos, d - 1, list_ref.get_ref());
+        pos.undo_move<color>(*i, acc);
     }
     return nodes;
 }
@@ -74,6 +142,20 @@ struct test_case{
         }
         return all_nodes_loc;
     }
+
+    void run_position_test(bool shallow){
+        const int d = shallow ? shallow_d : deep_d;
+        Position pos;
+        pos.parse_from_FEN(fen);
+        for(int i = 0; i < d; ++i){
+            const int nodes = (pos.get_turn() ? position_perft<White>(pos, i) : position_perft<Black>(pos, i));
+            if(nodes != results[i]){
+                cout << "ERRORERRORERROR    " << fen << " depth: " << i << " Expected: " << results[i] << " given: " << nodes << " (position)\n";
+            }
+            assert(nodes == results[i]);
+        }
+        cout << fen << " position SUCCESS\n";
+    }
 };
 
 
@@ -102,6 +184,13 @@ int main(){
     auto end = std::chrono::system_clock::now();
     auto elapsed = end - start;
     cout << (all_nodes / (std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() * 1e-6) ) << "nps\n"; 
+    #ifdef MAESTRO_PROFILE
+    cout << profile_thread.report();
+    #endif
+    for(auto &i : cases){
+        i.run_position_test(true);
+    }
+    bench_copy_make();
     //3.166122e+07nps
     //3.270218e+07nps
     //3.372886e+07nps
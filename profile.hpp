@@ -0,0 +1,112 @@
+#pragma once
+#include "types.hpp"
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+#else
+    #include <chrono>
+#endif
+
+namespace chess{
+
+    /// the hot functions timed under -DMAESTRO_PROFILE
+    enum ProfileSection : int{
+        Prof_gen_moves,
+        Prof_make_move,
+        Prof_undo_move,
+        Prof_eval,
+        Prof_nnue_eval,
+        Prof_sections
+    };
+
+    constexpr const char *profile_section_names[Prof_sections] = {
+        "gen_all_moves", "make_move", "undo_move", "eval_position", "nnue_evaluate"
+    };
+
+    struct ProfileCounter{
+        u64 calls = 0;
+        u64 cycles = 0;
+    };
+
+    /// timestamp counter ticks, nanoseconds where there is no RDTSC
+    inline u64 profile_clock(){
+        #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+        #else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        #endif
+    }
+
+    /// counters of one thread, profile_thread holds the calling thread's
+    struct Profile{
+        types::array<ProfileCounter, Prof_sections> counters{};
+
+        void clear(){
+            counters = {};
+        }
+
+        Profile& operator+=(const Profile &other){
+            for(int i = 0; i < Prof_sections; ++i){
+                counters[i].calls += other.counters[i].calls;
+                counters[i].cycles += other.counters[i].cycles;
+            }
+            return *this;
+        }
+
+        /// the ticks of an empty timed section, taken off every call in the report
+        static u64 overhead(){
+            u64 best = ~u64(0);
+            for(int i = 0; i < 10'000; ++i){
+                const u64 start = profile_clock();
+                best = std::min(best, profile_clock() - start);
+            }
+            return best;
+        }
+
+        /// a table of calls and cycles per call, one line per section that ran
+        std::string report()const{
+            const u64 cost = overhead();
+            u64 all = 0;
+            for(const ProfileCounter &counter : counters)
+                all += counter.cycles - std::min(counter.cycles, counter.calls * cost);
+            char line[128];
+            std::snprintf(line, sizeof(line), "%-16s %14s %14s %8s\n", "section", "calls", "cycles/call", "share");
+            std::string out = line;
+            for(int i = 0; i < Prof_sections; ++i){
+                const ProfileCounter &counter = counters[i];
+                if(counter.calls == 0)
+                    continue;
+                const u64 cycles = counter.cycles - std::min(counter.cycles, counter.calls * cost);
+                std::snprintf(line, sizeof(line), "%-16s %14llu %14.1f %7.1f%%\n", profile_section_names[i],
+                              static_cast<unsigned long long>(counter.calls), double(cycles) / counter.calls, all ? 100.0 * cycles / all : 0.0);
+                out += line;
+            }
+            std::snprintf(line, sizeof(line), "timer overhead of %llu cycles taken off every call\n", static_cast<unsigned long long>(cost));
+            return out + line;
+        }
+    };
+
+    inline thread_local Profile profile_thread;
+
+    class ProfileTimer{
+        ProfileCounter &counter;
+        u64 start;
+    public:
+        explicit ProfileTimer(const ProfileSection section):counter(profile_thread.counters[section]), start(profile_clock()){}
+        ~ProfileTimer(){
+            counter.cycles += profile_clock() - start;
+            ++counter.calls;
+        }
+    };
+}
+
+#define MAESTRO_PROFILE_CONCAT_(a, b) a##b
+#define MAESTRO_PROFILE_CONCAT(a, b) MAESTRO_PROFILE_CONCAT_(a, b)
+
+/// times the rest of the enclosing scope, nothing without -DMAESTRO_PROFILE
+#ifdef MAESTRO_PROFILE
+    #define MAESTRO_PROFILE_SCOPE(section) const chess::ProfileTimer MAESTRO_PROFILE_CONCAT(profile_timer_, __LINE__)(section)
+#else
+    #define MAESTRO_PROFILE_SCOPE(section) ((void)0)
+#endif
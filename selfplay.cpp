@@ -0,0 +1,147 @@
+#include "MainLogic/match.hpp"
+#include <cstdio>
+
+using namespace std;
+using namespace chess;
+
+// selfplay -engine <spec> -engine <spec> [-games n] [-threads n] [-openings file.epd] [-seed s]
+//          [-depth d | -nodes n | -movetime ms] [-sprt elo0 elo1 [alpha beta]]
+//          [-resign cp plies] [-draw cp plies move] [-maxplies n] [-tb directory]
+// an engine spec is "builtin" or a UCI command line in quotes, then name=value pairs: depth, nodes and
+// movetime override the limits for that engine, the rest are UCI options (EvalCache and EvalFile for builtin)
+// results are from the first engine's side, one line per game
+
+struct EngineSpec{
+    string command;
+    SearchLimits limits;
+    vector<pair<string, string>> options;
+};
+
+unique_ptr<MatchEngine> make_engine(const EngineSpec &spec){
+    if(spec.command == "builtin"){
+        auto engine = make_unique<BuiltinEngine>(spec.limits);
+        for(const auto &[name, value] : spec.options){
+            if(name == "EvalCache")
+                engine->get_ai().set_eval_cache_size(max(0, atoi(value.c_str())));
+            else if((name == "EvalFile") && !engine->load_network(value.c_str()))
+                fprintf(stderr, "can't load network %s\n", value.c_str());
+        }
+        return engine;
+    }
+    return make_unique<UciEngine>(spec.command, spec.options, spec.limits);
+}
+
+int main(int argc, char **argv){
+    vector<EngineSpec> specs;
+    int64_t games = 1000;
+    int threads = max(1u, thread::hardware_concurrency());
+    u64 seed = 1;
+    const char *openings_path = nullptr;
+    SearchLimits limits;
+    limits.depth = 4;
+    optional<Sprt> sprt;
+    Adjudication adjudication;
+    Tablebases tablebases;
+    for(int i = 1; i < argc; ++i){
+        const string arg = argv[i];
+        auto next = [&](){ return (i + 1 < argc) ? argv[++i] : ""; };
+        if(arg == "-engine"){
+            EngineSpec spec{next(), {}, {}};
+            while((i + 1 < argc) && (argv[i + 1][0] != '-')){
+                const string option = argv[++i];
+                const size_t equals = option.find('=');
+                spec.options.emplace_back(option.substr(0, equals), (equals == string::npos) ? "" : option.substr(equals + 1));
+            }
+            specs.push_back(spec);
+        }
+        else if(arg == "-games")
+            games = atoll(next());
+        else if(arg == "-threads")
+            threads = max(1, atoi(next()));
+        else if(arg == "-openings")
+            openings_path = next();
+        else if(arg == "-seed")
+            seed = strtoull(next(), nullptr, 10);
+        else if(arg == "-depth")
+            limits = {atoi(next()), 0, 0, false};
+        else if(arg == "-nodes")
+            limits = {64, atoll(next()), 0, false};
+        else if(arg == "-movetime")
+            limits = {64, 0, atoll(next()), false};
+        else if(arg == "-sprt"){
+            sprt = Sprt{};
+            sprt->elo0 = atof(next());
+            sprt->elo1 = atof(next());
+            if((i + 2 < argc) && (argv[i + 1][0] != '-')){
+                sprt->alpha = atof(next());
+                sprt->beta = atof(next());
+            }
+        }
+        else if(arg == "-resign"){
+            adjudication.resign_score = atoi(next());
+            adjudication.resign_plies = atoi(next());
+        }
+        else if(arg == "-draw"){
+            adjudication.draw_score = atoi(next());
+            adjudication.draw_plies = atoi(next());
+            adjudication.draw_move = atoi(next());
+        }
+        else if(arg == "-maxplies")
+            adjudication.max_plies = atoi(next());
+        else if(arg == "-tb"){
+            if(tablebases.load_directory(next()) != 0)
+                adjudication.tablebases = &tablebases;
+        }
+        else{
+            fprintf(stderr, "unknown argument %s\n", arg.c_str());
+            return 1;
+        }
+    }
+    if(specs.size() != 2){
+        fprintf(stderr, "two -engine specs are needed\n");
+        return 1;
+    }
+    // the per engine limits after the common ones
+    for(EngineSpec &spec : specs){
+        spec.limits = limits;
+        erase_if(spec.options, [&](const pair<string, string> &option){
+            if(option.first == "depth")
+                spec.limits = {atoi(option.second.c_str()), 0, 0, false};
+            else if(option.first == "nodes")
+                spec.limits = {64, atoll(option.second.c_str()), 0, false};
+            else if(option.first == "movetime")
+                spec.limits = {64, 0, atoll(option.second.c_str()), false};
+            else
+                return false;
+            return true;
+        });
+    }
+
+    vector<string> openings;
+    if(openings_path != nullptr){
+        openings = load_openings(openings_path, seed);
+        if(openings.empty()){
+            fprintf(stderr, "no openings in %s\n", openings_path);
+            return 1;
+        }
+    }
+    printf("%zu openings, %lld games on %d threads\n", max<size_t>(1, openings.size()), static_cast<long long>(games), threads);
+
+    Match match(openings, adjudication, sprt);
+    const char *result_names[] = {"0-1", "1/2-1/2", "1-0"};
+    const MatchScore score = match.run(games, threads, [&](const int engine){ return make_engine(specs[engine]); },
+        [&](const MatchScore &total, const int64_t game, const GameResult result, const string &reason){
+            const auto [elo, margin] = elo_estimate(total.wins, total.draws, total.losses);
+            printf("game %lld %s (%s)  +%lld =%lld -%lld  elo %.1f +- %.1f", static_cast<long long>(game + 1), result_names[result + 1],
+                   reason.c_str(), static_cast<long long>(total.wins), static_cast<long long>(total.draws), static_cast<long long>(total.losses), elo, margin);
+            if(sprt)
+                printf("  LLR %.2f (%.2f, %.2f)", sprt->llr(total.wins, total.draws, total.losses), sprt->lower_bound(), sprt->upper_bound());
+            printf("\n");
+            fflush(stdout);
+        });
+
+    if(sprt){
+        const int decision = sprt->decision(score.wins, score.draws, score.losses);
+        printf("%s\n", (decision > 0) ? "H1 accepted" : (decision < 0) ? "H0 accepted" : "inconclusive");
+    }
+}
@@ -0,0 +1,72 @@
+#include "MainLogic/fenView.hpp"
+#include "MainLogic/parallel.hpp"
+#include "ai.hpp"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace chess;
+
+// smp_bench [-d depth] [-t max_threads] [-m hash_mb]
+// ABDADA thread scaling: the searchtests.cpp positions searched to a fixed depth with 1, 2, 4, ... threads,
+// a fresh table for every search; prints time, nodes of all threads, nps and the speed-up over one thread
+
+const char *fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "4k3/8/8/pppppppp/PPPPPPPP/8/8/4K3 w - - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1",
+    "k7/8/8/8/3p1p2/8/2P1P1P1/4K3 w - - 0 1",
+    "8/PPP4k/8/8/8/8/ppp4K/8 w - - 0 1"
+};
+
+int main(int argc, char **argv){
+    int depth = 6;
+    int max_threads = max(1u, thread::hardware_concurrency());
+    size_t hash_mb = 64;
+    for(int i = 1; i + 1 < argc; i += 2){
+        const string arg = argv[i];
+        if(arg == "-d")
+            depth = atoi(argv[i + 1]);
+        else if(arg == "-t")
+            max_threads = max(1, atoi(argv[i + 1]));
+        else if(arg == "-m")
+            hash_mb = max(1, atoi(argv[i + 1]));
+    }
+
+    Board brd;
+    Movelist<5000> list;
+    Movelist_ref list_ref(list);
+    auto ai = make_unique<AI>(brd, list_ref);
+    ParallelSearch parallel(hash_mb);
+    SearchLimits limits;
+    limits.depth = depth;
+
+    double single_ms = 0;
+    printf("%8s %12s %14s %12s %8s\n", "threads", "time ms", "nodes", "nps", "speedup");
+    for(int threads = 1; threads <= max_threads; threads *= 2){
+        parallel.set_threads(threads);
+        int64_t nodes = 0;
+        double ms = 0;
+        for(const char *fen : fens){
+            parse_fen(fen, brd);
+            parallel.clear();
+            ai->clear_stop();
+            const auto start = chrono::steady_clock::now();
+            parallel.search(*ai, brd, limits, [](const SearchInfo&){});
+            ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+            nodes += ai->all_nodes + parallel.helper_nodes();
+        }
+        if(threads == 1)
+            single_ms = ms;
+        printf("%8d %12.0f %14lld %12lld %8.2f\n", threads, ms, static_cast<long long>(nodes),
+               static_cast<long long>(nodes * 1000 / max(1.0, ms)), single_ms / ms);
+        fflush(stdout);
+    }
+}
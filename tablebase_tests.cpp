@@ -0,0 +1,166 @@
+#include "MainLogic/fenView.hpp"
+#include "MainLogic/tbgen.hpp"
+#include "ai.hpp"
+#include <string>
+#include <cassert>
+#include <chrono>
+using namespace std;
+using namespace chess;
+
+Movelist<5000> list;
+
+TbProbe probe_fen(const Tablebases &tablebases, const string &fen){
+    Board brd;
+    assert(!parse_fen(fen, brd));
+    return tablebases.probe(brd);
+}
+
+// every entry agrees with one ply of probing its children
+void check_consistency(const Tablebases &tablebases, const MaterialKey key){
+    const TbTable *table = tablebases.find(key);
+    assert(table != nullptr);
+    const int count = table->get_piece_count();
+    int64_t wins = 0, draws = 0, losses = 0;
+    for(size_t index = 0; index < tb_entries(count); ++index){
+        if(table->wdl()[index] == TB_invalid)
+            continue;
+        Board brd;
+        brd.clear_board();
+        brd.set_castling(NO_Castling);
+        brd.set_en_passant(No_Square);
+        Square squares[8];
+        brd.set_turn(tb_decode_index(index, squares, count));
+        for(int i = 0; i < count; ++i)
+            brd.set_piece(squares[i], table->get_pieces()[i]);
+        brd.find_kings();
+
+        const TbProbe probe = tablebases.probe(brd);
+        assert(probe.found && (probe.wdl == table->wdl()[index]) && (probe.dtz == table->dtz()[index]));
+
+        Movelist_ref list_ref(list);
+        Movegen generator(brd, list_ref);
+        const PositionState state = brd.get_turn() ? generator.gen_all_moves<White>() : generator.gen_all_moves<Black>();
+        int best = TB_Loss, best_dtz = 1000, longest = 0;
+        if(list_ref.no_moves())
+            best = (state >= check) ? TB_Loss : TB_Draw;
+        for(Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+            const bool zeroing = (brd[i->to_square] != No_Piece) || (brd[i->from_square] % 6 == W_Pawn);
+            const Accumulator acc = brd.get_turn() ? brd.unstable_make_move<White>(*i) : brd.unstable_make_move<Black>(*i);
+            // no enemy pawn can take it in these tables
+            const Square en_passant = brd.get_en_passant();
+            brd.set_en_passant(No_Square);
+            const TbProbe child = tablebases.probe(brd);
+            brd.set_en_passant(en_passant);
+            brd.get_turn() ? brd.unstable_undo_move<Black>(*i, acc) : brd.unstable_undo_move<White>(*i, acc);
+            assert(child.found);
+
+            const int value = zeroing ? 1 : 1 + child.dtz;
+            best = max(best, -child.wdl);
+            if(child.wdl == TB_Loss)
+                best_dtz = min(best_dtz, value);
+            longest = max(longest, value);
+        }
+        assert(probe.wdl == best);
+        if(probe.wdl == TB_Win)
+            assert(probe.dtz == best_dtz);
+        else if((probe.wdl == TB_Loss) && !list_ref.no_moves())
+            assert(probe.dtz == longest);
+        wins += probe.wdl == TB_Win;
+        draws += probe.wdl == TB_Draw;
+        losses += probe.wdl == TB_Loss;
+    }
+    cout << material_name(key) << ": " << wins << " wins, " << draws << " draws, " << losses << " losses SUCCESS\n";
+}
+
+void check_positions(const Tablebases &tablebases){
+    TbProbe probe = probe_fen(tablebases, "k7/8/1K6/8/8/8/7Q/8 w - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Win) && (probe.dtz == 1));
+    probe = probe_fen(tablebases, "k7/1Q6/1K6/8/8/8/8/8 b - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Loss) && (probe.dtz == 0));
+    // the same as the first with the colors exchanged
+    probe = probe_fen(tablebases, "8/7q/8/8/8/1k6/8/K7 b - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Win) && (probe.dtz == 1));
+
+    probe = probe_fen(tablebases, "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Draw));
+    probe = probe_fen(tablebases, "4k3/4P3/4K3/8/8/8/8/8 w - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Win));
+    probe = probe_fen(tablebases, "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Win));
+    probe = probe_fen(tablebases, "8/8/8/8/8/2k5/8/KB6 w - - 0 1");
+    assert(probe.found && (probe.wdl == TB_Draw));
+
+    // castling rights, en passant and missing material are not probed
+    assert(!probe_fen(tablebases, "4k3/8/8/8/8/8/8/R3K3 w Q - 0 1").found);
+    assert(!probe_fen(tablebases, "4k3/8/8/8/4P3/8/8/4K3 b - e3 0 1").found);
+    assert(!probe_fen(tablebases, "4k3/8/8/8/8/8/8/RR2K3 w - - 0 1").found);
+    cout << "positions SUCCESS\n";
+}
+
+void check_files(const Tablebases &tablebases){
+    const MaterialKey key = material_from_name("KQvK");
+    assert(key != 0 && (material_name(key) == "KQvK"));
+    assert(material_from_name("KQ") == 0 && material_from_name("KQvKvK") == 0 && material_from_name("KXvK") == 0);
+
+    const char *path = "/tmp/tablebase_tests_KQvK.mtb";
+    assert(tablebases.find(key)->save(path));
+    Tablebases loaded;
+    assert(loaded.load(path) && (loaded.size() == 1) && (loaded.get_max_pieces() == 3));
+    const TbTable *original = tablebases.find(key), *mapped = loaded.find(key);
+    assert((mapped != nullptr) && (mapped != original));
+    assert(memcmp(original->wdl(), mapped->wdl(), tb_entries(3)) == 0);
+    assert(memcmp(original->dtz(), mapped->dtz(), tb_entries(3)) == 0);
+    remove(path);
+    assert(!loaded.load("/tmp/tablebase_tests_missing.mtb"));
+    cout << "files SUCCESS\n";
+}
+
+// the search follows the table to mate
+void check_search(const Tablebases &tablebases){
+    Board brd;
+    assert(!parse_fen("8/8/8/3k4/8/8/7Q/4K3 w - - 0 1", brd));
+    Movelist_ref list_ref(list);
+    AI bot(brd, list_ref);
+    bot.set_tablebases(&tablebases);
+    int dtz = tablebases.probe(brd).dtz;
+    assert(tablebases.probe(brd).wdl == TB_Win);
+    const int plies = 2 * dtz;
+    for(int ply = 0; ply < plies; ++ply){
+        Movelist_ref root(list);
+        Movegen generator(brd, root);
+        const bool white = brd.get_turn();
+        white ? generator.gen_all_moves<White>() : generator.gen_all_moves<Black>();
+        if(root.no_moves())
+            break;
+        bot.clear_stop();
+        const auto [move, score] = bot.search({2}, [](const SearchInfo&){});
+        white ? brd.unstable_make_move<White>(move) : brd.unstable_make_move<Black>(move);
+        const TbProbe probe = tablebases.probe(brd);
+        assert(probe.found);
+        if(white){
+            assert((probe.wdl == TB_Loss) && (probe.dtz < dtz));
+            dtz = probe.dtz;
+        }
+    }
+    assert(tablebases.probe(brd).wdl == TB_Loss && tablebases.probe(brd).dtz == 0);
+    cout << "search SUCCESS\n";
+}
+
+int main(){
+    Tablebases tablebases;
+    TbGenerator generator(tablebases);
+    for(const char *name : {"KvK", "KQvK", "KRvK", "KPvK"}){
+        const auto start = chrono::steady_clock::now();
+        assert(generator.generate(name));
+        const auto end = chrono::steady_clock::now();
+        cout << name << " generated in " << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms\n";
+    }
+    assert((tablebases.size() == 6) && (tablebases.get_max_pieces() == 3));
+    assert(!generator.generate("KQQQvK"));
+
+    for(const char *name : {"KvK", "KNvK", "KBvK", "KRvK", "KQvK", "KPvK"})
+        check_consistency(tablebases, material_from_name(name));
+    check_positions(tablebases);
+    check_files(tablebases);
+    check_search(tablebases);
+}
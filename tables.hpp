@@ -727,4 +727,16 @@ namespace chess
         else
             return black_pawns_attack_mask[id];
     }
+
+    /// squares attacked by a whole set of pawns
+    template <Color clr>
+    constexpr u64 colored_pawns_attack_mask(const u64 pawns)
+    {
+        constexpr u64 not_file_A = ~0x0101010101010101ull;
+        constexpr u64 not_file_H = ~0x8080808080808080ull;
+        if constexpr (clr)
+            return ((pawns & not_file_A) << 7) | ((pawns & not_file_H) << 9);
+        else
+            return ((pawns & not_file_H) >> 7) | ((pawns & not_file_A) >> 9);
+    }
 }
@@ -0,0 +1,59 @@
+#include "MainLogic/tuner.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+using namespace chess;
+
+// tuner [-t threads] [-e epochs] [-r rate] [-k scaling] [-o output] <file>...
+// Texel tuning of Board/evaltables.hpp on lines of "<FEN or EPD> <result>", the result as
+// "1-0", "0-1", "1/2-1/2" or a number from 0 to 1 for White, and writes the tuned tables to output
+
+int main(int argc, char **argv){
+    int threads = thread::hardware_concurrency(), epochs = 1000;
+    double rate = 1.0, k = 0.0;
+    string output = "evaltables.hpp";
+    vector<string> files;
+    for(int i = 1; i < argc; ++i){
+        const string arg = argv[i];
+        if((arg == "-t") && (i + 1 < argc))
+            threads = max(1, atoi(argv[++i]));
+        else if((arg == "-e") && (i + 1 < argc))
+            epochs = max(0, atoi(argv[++i]));
+        else if((arg == "-r") && (i + 1 < argc))
+            rate = atof(argv[++i]);
+        else if((arg == "-k") && (i + 1 < argc))
+            k = atof(argv[++i]);
+        else if((arg == "-o") && (i + 1 < argc))
+            output = argv[++i];
+        else
+            files.push_back(arg);
+    }
+
+    TexelTuner tuner(threads);
+    for(const string &file : files)
+        cout << file << ": " << tuner.load(file.c_str()) << " positions\n";
+    if(tuner.size() == 0){
+        cerr << "no positions\n";
+        return 1;
+    }
+
+    vector<double> params = default_tune_parameters();
+    if(k <= 0.0)
+        k = tuner.find_k(params);
+    cout << "K " << k << ", error " << tuner.error(params, k) << '\n';
+
+    const auto start = chrono::steady_clock::now();
+    tuner.tune(params, k, epochs, rate, [&](const int epoch, const double error){
+        const auto seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "epoch " << epoch << " error " << error << " " << seconds << " s" << endl;
+    });
+
+    ofstream out(output);
+    out << write_evaltables(params);
+    if(!out){
+        cerr << "can't write " << output << '\n';
+        return 1;
+    }
+    cout << "written to " << output << '\n';
+}
@@ -0,0 +1,132 @@
+#include "MainLogic/tuner.hpp"
+#include "MainLogic/fenView.hpp"
+#include "ai.hpp"
+#include <string>
+#include <cassert>
+#include <chrono>
+#include <sstream>
+using namespace std;
+using namespace chess;
+
+Movelist<5000> list;
+vector<string> fens;
+
+// every position up to d plies from the start, as FENs
+template<Color clr>
+void collect(Board &brd, const int d, Movelist_ref list_ref){
+    char buffer[fen_buffer_size];
+    fens.emplace_back(buffer, write_fen(buffer, brd));
+    if(d == 0)
+        return;
+    Movegen generator(brd, list_ref);
+    generator.gen_all_moves<clr>();
+    for(Move_full_info *i = list_ref.begin; i != list_ref.end; ++i){
+        const Accumulator acc = brd.unstable_make_move<clr>(*i);
+        collect<change_color(clr)>(brd, d - 1, list_ref.get_ref());
+        brd.unstable_undo_move<clr>(*i, acc);
+    }
+}
+
+void check_results(){
+    assert(parse_game_result(" c9 \"1-0\";") == 1.0);
+    assert(parse_game_result(" c9 \"0-1\";") == 0.0);
+    assert(parse_game_result(" c9 \"1/2-1/2\";") == 0.5);
+    assert(parse_game_result(" [0.5]") == 0.5);
+    assert(parse_game_result(" | 1.0") == 1.0);
+    assert(parse_game_result(" bm e4;") == -1.0);
+    assert(parse_game_result(" [1.5]") == -1.0);
+    TexelTuner tuner(1);
+    assert(!tuner.add("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"));
+    assert(!tuner.add("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1 [0.5]"));
+    assert(tuner.add("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 [0.5]") && (tuner.size() == 1));
+    cout << "results SUCCESS\n";
+}
+
+// the linear form of the tables gives eval_position before it is rounded
+void check_evaluation(TexelTuner &tuner){
+    const vector<double> params = default_tune_parameters();
+    const vector<float> values(params.begin(), params.end());
+    for(size_t i = 0; i < fens.size(); ++i){
+        Board brd;
+        assert(!parse_fen(fens[i], brd));
+        const float eval = tuner.evaluate(i, values.data());
+        assert(abs(eval - brd.eval_position()) < 1.01f);
+    }
+    cout << fens.size() << " evaluations SUCCESS\n";
+}
+
+void check_gradient(const TexelTuner &tuner){
+    vector<double> params = default_tune_parameters(), grad;
+    const double k = 1.0;
+    tuner.gradient(params, k, grad);
+    for(const int index : {tune_material + 2, tune_squares + 2 * (1 * 64 + 18), tune_squares + 2 * (0 * 64 + 52) + 1, tune_passed + 2 * 4 + 1}){
+        const double original = params[index], step = 0.5;
+        params[index] = original + step;
+        const double above = tuner.error(params, k);
+        params[index] = original - step;
+        const double below = tuner.error(params, k);
+        params[index] = original;
+        const double numeric = (above - below) / (2 * step);
+        assert(abs(numeric - grad[index]) <= 1e-3 * abs(numeric) + 1e-9);
+    }
+    cout << "gradient SUCCESS\n";
+}
+
+// labels from the tables themselves are found again from flat squares
+void check_tuning(){
+    const vector<double> truth = default_tune_parameters();
+    const vector<float> values(truth.begin(), truth.end());
+    TexelTuner labeler(1);
+    for(const string &fen : fens)
+        assert(labeler.add(fen + " [0.5]"));
+    TexelTuner tuner(4);
+    for(size_t i = 0; i < fens.size(); ++i){
+        const double result = 1.0 / (1.0 + pow(10.0, -labeler.evaluate(i, values.data()) / 400.0));
+        assert(tuner.add(fens[i] + " [" + to_string(result) + "]"));
+    }
+    assert(tuner.error(truth, 1.0) < 1e-9);
+    assert(abs(tuner.find_k(truth) - 1.0) < 0.01);
+
+    vector<double> params = truth;
+    for(int i = tune_squares; i < tune_parameters; ++i)
+        params[i] = 0.0;
+    const double before = tuner.error(params, 1.0);
+    const auto start = chrono::steady_clock::now();
+    tuner.tune(params, 1.0, 200, 2.0, [](const int epoch, const double error){
+        cout << "epoch " << epoch << " error " << error << '\n';
+    });
+    const auto end = chrono::steady_clock::now();
+    const double after = tuner.error(params, 1.0);
+    cout << "error " << before << " -> " << after << " in " << chrono::duration<double>(end - start).count() << " s\n";
+    assert(after < before / 4);
+    cout << "tuning SUCCESS\n";
+}
+
+// the default parameters write the tables the engine is built with
+void check_header(){
+    ifstream in("Board/evaltables.hpp");
+    assert(in);
+    stringstream file;
+    file << in.rdbuf();
+    assert(write_evaltables(default_tune_parameters()) == file.str());
+    cout << "header SUCCESS\n";
+}
+
+int main(){
+    check_results();
+    for(const char *fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                           "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                           "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"}){
+        Board brd;
+        assert(!parse_fen(fen, brd));
+        Movelist_ref list_ref(list);
+        brd.get_turn() ? collect<White>(brd, 2, list_ref) : collect<Black>(brd, 2, list_ref);
+    }
+    TexelTuner tuner(4);
+    for(size_t i = 0; i < fens.size(); ++i)
+        assert(tuner.add(fens[i] + ((i % 3 == 0) ? " \"1-0\";" : (i % 3 == 1) ? " \"0-1\";" : " \"1/2-1/2\";")));
+    check_evaluation(tuner);
+    check_gradient(tuner);
+    check_tuning();
+    check_header();
+}
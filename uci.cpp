@@ -0,0 +1,21 @@
+#include "MainLogic/uci.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// uci             speaks UCI on stdin/stdout
+// uci bench [d]   searches the bench positions to depth d and prints the node signature and nps
+int main(int argc, char **argv){
+    if((argc > 1) && (strcmp(argv[1], "bench") == 0)){
+        const int depth = (argc > 2) ? atoi(argv[2]) : chess::bench_default_depth;
+        const chess::BenchResult result = chess::run_bench(depth, [](const int index, const char *fen, const int64_t nodes){
+            fprintf(stderr, "%2d %s: %lld\n", index + 1, fen, static_cast<long long>(nodes));
+        });
+        printf("nodes %lld\nnps %lld\ntime %lld\n", static_cast<long long>(result.nodes), static_cast<long long>(result.nps()),
+               static_cast<long long>(result.time_ms));
+        return 0;
+    }
+    std::ios::sync_with_stdio(false);
+    chess::UCI uci;
+    uci.loop();
+}